@@ -29,6 +29,8 @@ typedef struct {
     long N3i;
     long N3w;
     long N3iw;
+    long N3n;
+    long N3nw;
     long N4;
     long K;
     long m;
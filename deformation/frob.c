@@ -316,6 +316,208 @@ void _qadic_mat_mul(fmpz_poly_mat_t C,
         }
 }
 
+/*
+    Sets pos[i] to the index of row i within its block, given the 
+    labels blk of length b, and len[c] to the size of block c.
+ */
+static 
+void _frob_block_pos(long *pos, long *len, const long *blk, long b, long nb)
+{
+    long c, i;
+
+    for (c = 0; c < nb; c++)
+        len[c] = 0;
+    for (i = 0; i < b; i++)
+        pos[i] = len[blk[i]]++;
+}
+
+/*
+    Sets (C, vC) to the block diagonal matrix with the nb diagonal 
+    blocks (Cc[c], vc[c]), and clears the blocks.
+ */
+static 
+void _frob_set_blocks(fmpz_poly_mat_t C, long *vC, 
+                      fmpz_poly_mat_struct *Cc, const long *vc, 
+                      const long *blk, const long *pos, long nb, 
+                      const fmpz_t p)
+{
+    const long b = C->r;
+
+    long c, i, j, v = LONG_MAX;
+    fmpz *f;
+
+    for (c = 0; c < nb; c++)
+        v = FLINT_MIN(v, vc[c]);
+
+    f = _fmpz_vec_init(nb);
+    for (c = 0; c < nb; c++)
+        fmpz_pow_ui(f + c, p, vc[c] - v);
+
+    fmpz_poly_mat_zero(C);
+    for (i = 0; i < b; i++)
+        for (j = 0; j < b; j++)
+            if (blk[i] == blk[j])
+                fmpz_poly_scalar_mul_fmpz(fmpz_poly_mat_entry(C, i, j), 
+                    fmpz_poly_mat_entry(Cc + blk[i], pos[i], pos[j]), 
+                    f + blk[i]);
+    *vC = v;
+
+    for (c = 0; c < nb; c++)
+        fmpz_poly_mat_clear(Cc + c);
+    _fmpz_vec_clear(f, nb);
+}
+
+/*
+    Sets (C, vC) to the local solution of $(d/dt + M) C = 0$ modulo 
+    $t^K$, as computed by \code{gmde_solve()}, solving the 
+    system independently on each of the nb diagonal blocks of $M$ 
+    given by the labels blk.
+ */
+static 
+void _frob_solve_blocks(fmpz_poly_mat_t C, long *vC, long K, const fmpz_t p, 
+                        long N, long Nw, const mat_t M, const ctx_t ctx, 
+                        const long *blk, long nb)
+{
+    const long b = M->m;
+
+    padic_mat_struct *A;
+    long c, i, j, k, *pos, *len, *vc;
+    __mat_struct *Mc;
+    fmpz_poly_mat_struct *Cc;
+
+    if (nb == 1)
+    {
+        gmde_solve(&A, K, p, N, Nw, M, ctx);
+        gmde_convert_soln(C, vC, A, K, p);
+
+        for (k = 0; k < K; k++)
+            padic_mat_clear(A + k);
+        free(A);
+        return;
+    }
+
+    pos = malloc(b * sizeof(long));
+    len = malloc(nb * sizeof(long));
+    vc  = malloc(nb * sizeof(long));
+    Mc  = malloc(nb * sizeof(__mat_struct));
+    Cc  = malloc(nb * sizeof(fmpz_poly_mat_struct));
+
+    _frob_block_pos(pos, len, blk, b, nb);
+
+    for (c = 0; c < nb; c++)
+        mat_init(Mc + c, len[c], len[c], ctx);
+    for (i = 0; i < b; i++)
+        for (j = 0; j < b; j++)
+            if (blk[i] == blk[j])
+                ctx->set(ctx, mat_entry(Mc + blk[i], pos[i], pos[j], ctx), 
+                              mat_entry(M, i, j, ctx));
+
+    for (c = 0; c < nb; c++)
+    {
+        gmde_solve(&A, K, p, N, Nw, Mc + c, ctx);
+        fmpz_poly_mat_init(Cc + c, len[c], len[c]);
+        gmde_convert_soln(Cc + c, vc + c, A, K, p);
+
+        for (k = 0; k < K; k++)
+            padic_mat_clear(A + k);
+        free(A);
+        mat_clear(Mc + c, ctx);
+    }
+
+    _frob_set_blocks(C, vC, Cc, vc, blk, pos, nb, p);
+
+    free(pos);
+    free(len);
+    free(vc);
+    free(Mc);
+    free(Cc);
+}
+
+/*
+    Sets (B, vB) to the inverse of (A, vA) modulo $t^K$ as computed 
+    by \code{gmde_inv_series()}, inverting each of the nb diagonal 
+    blocks of $A$ given by the labels blk independently.
+ */
+static 
+void _frob_inv_blocks(fmpz_poly_mat_t B, long *vB, 
+                      const fmpz_poly_mat_t A, long vA, long K, 
+                      const fmpz_t p, long N, long Nw, 
+                      const long *blk, long nb)
+{
+    const long b = A->r;
+
+    long c, i, j, *pos, *len, *vc;
+    fmpz_poly_mat_struct *Ac, *Bc;
+
+    if (nb == 1)
+    {
+        gmde_inv_series(B, vB, A, vA, K, p, N, Nw);
+        return;
+    }
+
+    pos = malloc(b * sizeof(long));
+    len = malloc(nb * sizeof(long));
+    vc  = malloc(nb * sizeof(long));
+    Ac  = malloc(nb * sizeof(fmpz_poly_mat_struct));
+    Bc  = malloc(nb * sizeof(fmpz_poly_mat_struct));
+
+    _frob_block_pos(pos, len, blk, b, nb);
+
+    for (c = 0; c < nb; c++)
+        fmpz_poly_mat_init(Ac + c, len[c], len[c]);
+    for (i = 0; i < b; i++)
+        for (j = 0; j < b; j++)
+            if (blk[i] == blk[j])
+                fmpz_poly_set(fmpz_poly_mat_entry(Ac + blk[i], pos[i], pos[j]), 
+                              fmpz_poly_mat_entry(A, i, j));
+
+    for (c = 0; c < nb; c++)
+    {
+        fmpz_poly_mat_init(Bc + c, len[c], len[c]);
+        gmde_inv_series(Bc + c, vc + c, Ac + c, vA, K, p, N, Nw);
+        fmpz_poly_mat_clear(Ac + c);
+    }
+
+    _frob_set_blocks(B, vB, Bc, vc, blk, pos, nb, p);
+
+    free(pos);
+    free(len);
+    free(vc);
+    free(Ac);
+    free(Bc);
+}
+
+/*
+    Decides whether to compute $C^{-1}(t)$ modulo $t^L$, where 
+    $L = \lceil K/p \rceil$, by Newton inversion of $C(t)$ rather 
+    than by solving the differential system for $-M^t$.
+
+    Counts coefficient operations weighted by the working precision. 
+    Solving the system costs about $L (\ell_B b + \ell_r) b^2$ 
+    operations, where $\ell_B$ and $\ell_r$ are the lengths of the 
+    numerator and the denominator of $M$, whereas Newton iteration 
+    costs about four products of $b \times b$ polynomial matrices 
+    of length~$L$ and requires $C$ to be computed to higher precision.
+ */
+static 
+int _frob_cinv_newton(long b, long lenB, long lenR, const prec_t *prec, 
+                      const fmpz_t p)
+{
+    const long K = prec->K;
+    const long L = (K + (*p) - 1) / (*p);
+
+    double ode, newton;
+
+    if (L < 2)
+        return 0;
+
+    ode    = (double) L * (lenB * b + lenR) * b * b * prec->N3iw;
+    newton = 4.0 * L * FLINT_CLOG2(L) * b * b * b * prec->N3nw 
+           + (double) K * (lenB * b + lenR) * b * b * (prec->N3nw - prec->N3w);
+
+    return newton < ode;
+}
+
 /*
     Step 1.
 
@@ -331,7 +533,12 @@ void _qadic_mat_mul(fmpz_poly_mat_t C,
 
     Compute solution $C(t)$ over $\mathbf{Q}_p[[t]]$ modulo 
     $p^{N_2}$ and $t^{K}$.  Also compute $C^{-1}(t^p)$ to 
-    the same precision.
+    the same precision, either by solving the differential 
+    system for $-M^t$ or by Newton inversion of $C(t)$, 
+    whichever is estimated to be cheaper.  Since $M$ is block 
+    diagonal with respect to the character blocks of the basis, 
+    so are $C(t)$ and $C^{-1}(t)$, and both are computed one 
+    block at a time.
 
     Step 4.
 
@@ -378,10 +585,16 @@ void frob_ret(fmpz_poly_t cp,
     mat_t M;
     mon_t *bR, *bC;
     fmpz_poly_t r;
+    const char *cache;
+
+    /* Character blocks of M */
+    long *blk, nb;
 
     /* Local solution */
     fmpz_poly_mat_t C, Cinv;
     long vC, vCinv;
+    long lenB;
+    int newton;
 
     /* Frobenius */
     fmpz_poly_mat_t F;
@@ -410,11 +623,15 @@ void frob_ret(fmpz_poly_t cp,
     mat_init(M, b, b, ctxFracQt);
     fmpz_poly_init(r);
 
-    gmc_compute(M, &bR, &bC, P, ctxFracQt);
+    /* Look up (M, r) in the cache directory GMC_CACHE_DIR, if set */
+    cache = getenv("GMC_CACHE_DIR");
 
+    if (!(cache && gmc_cache_load(M, &bR, &bC, r, P, cache, ctxFracQt)))
     {
         fmpz_poly_t t;
 
+        gmc_compute(M, &bR, &bC, P, ctxFracQt);
+
         fmpz_poly_init(t);
         fmpz_poly_set_ui(r, 1);
         for (i = 0; i < M->m; i++)
@@ -425,8 +642,14 @@ void frob_ret(fmpz_poly_t cp,
                 fmpz_poly_swap(r, t);
             }
         fmpz_poly_clear(t);
+
+        if (cache)
+            gmc_cache_store(M, bR, r, P, cache, ctxFracQt);
     }
 
+    blk = malloc(b * sizeof(long));
+    nb  = gmc_character_blocks(blk, bR, b, P, ctxFracQt);
+
     c1 = clock();
     c  = (double) (c1 - c0) / CLOCKS_PER_SEC;
 
@@ -434,6 +657,7 @@ void frob_ret(fmpz_poly_t cp,
     {
         printf("Gauss-Manin connection:\n");
         printf("  r(t) = "), fmpz_poly_print_pretty(r, "t"), printf("\n");
+        printf("  Blocks = %ld\n", nb);
         printf("  Time = %f\n", c);
         printf("\n");
         fflush(stdout);
@@ -475,6 +699,8 @@ void frob_ret(fmpz_poly_t cp,
         printf("  N3i  = %ld\n", prec->N3i);
         printf("  N3w  = %ld\n", prec->N3w);
         printf("  N3iw = %ld\n", prec->N3iw);
+        printf("  N3n  = %ld\n", prec->N3n);
+        printf("  N3nw = %ld\n", prec->N3nw);
         printf("  N4   = %ld\n", prec->N4);
         printf("  m    = %ld\n", prec->m);
         printf("  K    = %ld\n", prec->K);
@@ -536,17 +762,41 @@ void frob_ret(fmpz_poly_t cp,
         the local solution of the differential equation replacing M by Mt.
      */
 
+    /* Length of the numerator of M = B / r */
+    lenB = 0;
+    for (i = 0; i < b; i++)
+        for (j = 0; j < b; j++)
+        {
+            const fmpz_poly_q_struct *e = 
+                (fmpz_poly_q_struct *) mat_entry(M, i, j, ctxFracQt);
+
+            if (!fmpz_poly_q_is_zero(e))
+                lenB = FLINT_MAX(lenB, fmpz_poly_length(fmpz_poly_q_numref(e)) 
+                                       + fmpz_poly_degree(r) 
+                                       - fmpz_poly_degree(fmpz_poly_q_denref(e)));
+        }
+
+    newton = _frob_cinv_newton(b, lenB, fmpz_poly_length(r), prec, p);
+
     c0 = clock();
+    if (newton)
+        _frob_solve_blocks(C, &vC, prec->K, p, prec->N3n, prec->N3nw, 
+                           M, ctxFracQt, blk, nb);
+    else
+        _frob_solve_blocks(C, &vC, prec->K, p, prec->N3, prec->N3w, 
+                           M, ctxFracQt, blk, nb);
     {
-        const long K = prec->K;
-        padic_mat_struct *A;
-
-        gmde_solve(&A, K, p, prec->N3, prec->N3w, M, ctxFracQt);
-        gmde_convert_soln(C, &vC, A, K, p);
+        flint_rand_t state;
 
-        for(i = 0; i < K; i++)
-            padic_mat_clear(A + i);
-        free(A);
+        _randinit(state);
+        if (!gmde_check_soln_random(C, vC, p, newton ? prec->N3n : prec->N3, 
+                                    prec->K, M, ctxFracQt, state))
+        {
+            printf("Exception (deformation_frob).\n");
+            printf("The local solution C(t) fails to satisfy (d/dt + M) C = 0.\n");
+            abort();
+        }
+        _randclear(state);
     }
     c1 = clock();
     c  = (double) (c1 - c0) / CLOCKS_PER_SEC;
@@ -558,30 +808,48 @@ void frob_ret(fmpz_poly_t cp,
     }
 
     c0 = clock();
+    if (newton)
+    {
+        const long K = (prec->K + (*p) - 1) / (*p);
+
+        _frob_inv_blocks(Cinv, &vCinv, C, vC, K, p, prec->N3i, prec->N3nw,
+                         blk, nb);
+
+        /* The condition of gmde_inv_series() on the working precision */
+        if (prec->N3nw < prec->N3i - n_clog(K, 2) * (vC + vCinv))
+        {
+            printf("Exception (deformation_frob).\n");
+            printf("The working precision N3nw = %ld is insufficient for the\n",
+                   prec->N3nw);
+            printf("Newton inversion of C(t) with vC = %ld and vCinv = %ld.\n",
+                   vC, vCinv);
+            abort();
+        }
+
+        fmpz_poly_mat_compose_pow(Cinv, Cinv, *p);
+    }
+    else
     {
         const long K = (prec->K + (*p) - 1) / (*p);
         mat_t Mt;
-        padic_mat_struct *Ainv;
 
         mat_init(Mt, b, b, ctxFracQt);
         mat_transpose(Mt, M, ctxFracQt);
         mat_neg(Mt, Mt, ctxFracQt);
-        gmde_solve(&Ainv, K, p, prec->N3i, prec->N3iw, Mt, ctxFracQt);
-        gmde_convert_soln(Cinv, &vCinv, Ainv, K, p);
+        _frob_solve_blocks(Cinv, &vCinv, K, p, prec->N3i, prec->N3iw, 
+                           Mt, ctxFracQt, blk, nb);
 
         fmpz_poly_mat_transpose(Cinv, Cinv);
         fmpz_poly_mat_compose_pow(Cinv, Cinv, *p);
 
-        for(i = 0; i < K; i++)
-            padic_mat_clear(Ainv + i);
-        free(Ainv);
         mat_clear(Mt, ctxFracQt);
     }
     c1 = clock();
     c  = (double) (c1 - c0) / CLOCKS_PER_SEC;
     if (verbose)
     {
-        printf("  Time for C^{-1} = %f\n", c);
+        printf("  Time for C^{-1} = %f (%s)\n", c, 
+               newton ? "Newton inversion" : "differential system");
         printf("\n");
         fflush(stdout);
     }
@@ -942,6 +1210,7 @@ void frob_ret(fmpz_poly_t cp,
     mat_clear(M, ctxFracQt);
     free(bR);
     free(bC);
+    free(blk);
     fmpz_poly_clear(r);
 
     fmpz_poly_mat_clear(C);
@@ -138,6 +138,25 @@ void deformation_precisions(prec_t *prec,
     prec->N3iw = prec->N3i + (f + 1) * n_clog((prec->K + *p - 1) / *p, *p);
     prec->N4   = prec->N2  + f * (n_clog(prec->K, *p) + n_clog((prec->K + *p - 1) / *p, *p));
 
+    /*
+        When C^{-1} is obtained by inverting C modulo t^L as a power 
+        series rather than by solving the transposed system, C has to be 
+        known to the precision required for C^{-1} plus twice the loss 
+        from the denominators of C^{-1}, which have valuation at least 
+        -f clog_p(L) by the bound used for N3.  Each of the s = clog_2(L) 
+        steps of gmde_inv_series() loses vC + vCinv >= -f (clog_p(K) + 
+        clog_p(L)), so N3nw covers this as well as the working precision 
+        for computing C itself to precision N3n.
+     */
+    {
+        const long L = (prec->K + *p - 1) / *p;
+        const long e = n_clog(prec->K, *p) + n_clog(L, *p);
+
+        prec->N3n  = FLINT_MAX(prec->N3, prec->N3i) + 2 * f * n_clog(L, *p);
+        prec->N3nw = FLINT_MAX(prec->N3n + (f + 1) * n_clog(prec->K, *p), 
+                               prec->N3i + n_clog(L, 2) * f * e);
+    }
+
     prec->denR = NULL;
 }
 
@@ -1,8 +0,0 @@
-#!/bin/bash
-
-POLY="4  [4 0 0 0] [0 4 0 0] [0 0 4 0] [0 0 0 4] (2  0 -3)[3 1 0 0] (2  0 5)[3 0 1 0] (2  0 7)[2 1 1 0] (2  0 -23)[1 2 1 0] (2  0 -29)[0 2 1 1] (2  0 31)[0 0 2 2] (2  0 -37)[1 1 1 1]"
-N=1
-OUT=gmconnection-06
-
-./gmconnection-p "$POLY" $N > $OUT
-
@@ -1,8 +0,0 @@
-#!/bin/bash
-
-POLY="4  (2  1 -1)[5 0 0 0] (2  1 -1)[0 5 0 0] (2  0 1)[2 0 3 0] (2  0 1)[0 1 4 0] (2  1 -1)[0 0 5 0] (2  0 1)[3 1 0 1] (2  0 1)[1 2 1 1] (2  0 1)[0 0 3 2] (2  0 1)[1 1 0 3] (2  1 -1)[0 0 0 5]"
-N=1
-OUT=gmconnection-07
-
-./gmconnection-p "$POLY" $N > $OUT
-
@@ -0,0 +1,285 @@
+/******************************************************************************
+
+    Benchmark for the computation of the Gauss--Manin connection.
+
+    Usage:  gmconnection-bench [-r reps] [-w warmup] [-f family | poly]
+
+    Runs gmc_compute() on a curated list of families of increasing
+    dimension n and degree d, or only on the named family or the given
+    polynomial, with the given number of warm-up runs and repetitions.
+    For every repetition, gmc_compute_cached() is called with fresh
+    symbolic data whose phase timers are enabled, so that the time of
+    each of the following consecutive phases of the very same run is
+    reported alongside the total:
+
+        setup     the partial derivatives and the index sets and levels
+        aux       constructing and factoring the auxiliary matrices
+        image     the memoised reductions of the monomials of dP/dt
+        reduce    the reduction of the basis columns
+
+    Each family runs in a child process of its own.  Prints one line of
+    tab-separated values per family and phase, with the wall clock times
+    in seconds and the peak resident set size of the family's process
+    in kilobytes.  The header line and the order of the fields are
+    stable, so that the output of different builds can be compared
+    directly.  A family whose process fails is reported by a line with
+    FAILED in place of its measurements, and the exit status is then
+    non-zero, as it is for an unknown family name.
+
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <gmp.h>
+
+#include "flint/flint.h"
+#include "flint/fmpz.h"
+#include "flint/ulong_extras.h"
+
+#include "mpoly.h"
+#include "mat_csr.h"
+#include "gmconnection.h"
+
+typedef struct
+{
+    const char *name;
+    long reps;
+    const char *poly;
+} bench_family;
+
+static const bench_family families[] = {
+    { "n2d3",   100, "3  [3 0 0] [0 3 0] [0 0 3] (2  0 1)[1 1 1]" },
+    { "n2d4",    50, "3  [4 0 0] [0 4 0] [0 0 4] (2  0 1)[2 1 1]" },
+    { "n2d5",    20, "3  [5 0 0] [0 5 0] [0 0 5] (2  0 1)[3 1 1] (2  0 1)[1 2 2]" },
+    { "n3d4a",   10, "4  [4 0 0 0] [0 4 0 0] [0 0 4 0] [0 0 0 4] (2  0 1)[1 1 1 1]" },
+    { "n3d4b",    3, "4  [4 0 0 0] [0 4 0 0] [0 0 4 0] [0 0 0 4] (2  0 1)[3 1 0 0] (2  0 1)[1 0 1 2] (2  0 1)[0 1 0 3]" },
+    { "n3d4c",    3, "4  [4 0 0 0] [0 4 0 0] [0 0 4 0] [0 0 0 4] (2  0 1)[3 1 0 0] (2  0 1)[1 0 1 2] (2  0 1)[0 1 0 3] (2  0 1)[1 1 1 1]" },
+    { "n3d4d",    3, "4  [4 0 0 0] [0 4 0 0] [0 0 4 0] [0 0 0 4] (2  0 2)[3 1 0 0] (2  0 7)[2 1 1 0] (2  0 -11)[1 2 1 0] (2  0 13)[0 2 1 1] (2  0 17)[0 2 0 2] (2  0 -1)[1 1 1 1]" },
+    { "n3d4e",    3, "4  [4 0 0 0] [0 4 0 0] [0 0 4 0] [0 0 0 4] (2  0 -3)[3 1 0 0] (2  0 5)[3 0 1 0] (2  0 7)[2 1 1 0] (2  0 -23)[1 2 1 0] (2  0 -29)[0 2 1 1] (2  0 31)[0 0 2 2] (2  0 -37)[1 1 1 1]" },
+    { "n3d5",     1, "4  (2  1 -1)[5 0 0 0] (2  1 -1)[0 5 0 0] (2  0 1)[2 0 3 0] (2  0 1)[0 1 4 0] (2  1 -1)[0 0 5 0] (2  0 1)[3 1 0 1] (2  0 1)[1 2 1 1] (2  0 1)[0 0 3 2] (2  0 1)[1 1 0 3] (2  1 -1)[0 0 0 5]" }
+};
+
+#define NFAMILIES  ((long) (sizeof(families) / sizeof(bench_family)))
+
+/* The total time, followed by the phases GMC_PHASE_SETUP, ... */
+#define NPHASES  (GMC_NPHASES + 1)
+
+static const char *phases[NPHASES] = { "total", "setup", "aux", "image", "reduce" };
+
+static double bench_clock(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1.0e-9 * ts.tv_nsec;
+}
+
+static int bench_cmp(const void *a, const void *b)
+{
+    const double x = *(const double *) a, y = *(const double *) b;
+
+    return (x < y) ? -1 : ((x > y) ? 1 : 0);
+}
+
+/* Returns the p-th percentile of the sorted array t of length N */
+static double bench_percentile(const double *t, long N, long p)
+{
+    long i = (p * N + 99) / 100 - 1;
+
+    return t[FLINT_MAX(0, FLINT_MIN(N - 1, i))];
+}
+
+/*
+    Runs the benchmark for one family and prints its lines, with the 
+    peak resident set size of the calling process.
+ */
+static void bench_family_run(const char *name, const char *str,
+                             long reps, long warmup, const ctx_t ctx)
+{
+    struct rusage usage;
+    mpoly_t P;
+    mat_t M;
+    mon_t *rows, *cols;
+    gmc_symbolic_t S;
+    long b, d, n, i, r;
+    double *t;
+
+    n = atoi(str) - 1;
+    mpoly_init(P, n + 1, ctx);
+    mpoly_set_str(P, str, ctx);
+    d = mpoly_degree(P, -1, ctx);
+    b = gmc_basis_size(n, d);
+
+    t = calloc(NPHASES * reps, sizeof(double));
+
+    for (r = -warmup; r < reps; r++)
+    {
+        double c, u[NPHASES] = { 0.0 };
+
+        mat_init(M, b, b, ctx);
+
+        /* A fresh S for every repetition, timing the phases into u */
+        gmc_symbolic_init(S);
+        S->time = u + 1;
+
+        c = bench_clock();
+        gmc_compute_cached(M, &rows, &cols, P, S, ctx);
+        u[0] = bench_clock() - c;
+
+        gmc_symbolic_clear(S, ctx);
+
+        mat_clear(M, ctx);
+        free(rows);
+        free(cols);
+
+        if (r >= 0)
+            for (i = 0; i < NPHASES; i++)
+                t[i * reps + r] = u[i];
+    }
+
+    getrusage(RUSAGE_SELF, &usage);
+
+    for (i = 0; i < NPHASES; i++)
+    {
+        double *v = t + i * reps;
+
+        qsort(v, reps, sizeof(double), bench_cmp);
+        printf("%s\t%ld\t%ld\t%ld\t%s\t%ld\t%.6f\t%.6f\t%.6f\t%.6f\t%.6f\t%ld\n",
+               name, n, d, b, phases[i], reps,
+               bench_percentile(v, reps, 50), bench_percentile(v, reps, 10),
+               bench_percentile(v, reps, 90), v[0], v[reps - 1], 
+               (long) usage.ru_maxrss);
+        fflush(stdout);
+    }
+
+    free(t);
+    mpoly_clear(P, ctx);
+}
+
+/*
+    Runs the benchmark for one family in a child process of its own, 
+    so that the reported peak memory is that of the family alone. 
+    Falls back to running it in this process if the fork fails.
+
+    Returns 1 on success.  If the child does not exit successfully, 
+    prints a line with the name of the family and FAILED in place of 
+    its measurements, followed by the reason, and returns 0.
+ */
+static int bench_family_fork(const char *name, const char *str,
+                             long reps, long warmup, const ctx_t ctx)
+{
+    pid_t pid;
+
+    fflush(stdout);
+    pid = fork();
+
+    if (pid == 0)
+    {
+        bench_family_run(name, str, reps, warmup, ctx);
+        fflush(stdout);
+        _exit(EXIT_SUCCESS);
+    }
+    else if (pid > 0)
+    {
+        int status;
+
+        if (waitpid(pid, &status, 0) != pid)
+        {
+            printf("%s\tFAILED\twaitpid\n", name);
+        }
+        else if (WIFSIGNALED(status))
+        {
+            printf("%s\tFAILED\tsignal %d\n", name, WTERMSIG(status));
+        }
+        else if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+        {
+            printf("%s\tFAILED\texit status %d\n", name, 
+                   WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+        }
+        else
+        {
+            return 1;
+        }
+
+        fflush(stdout);
+        return 0;
+    }
+    else
+    {
+        bench_family_run(name, str, reps, warmup, ctx);
+        return 1;
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    ctx_t ctx;
+    const char *family = NULL, *poly = NULL;
+    long i, reps = 0, warmup = 1;
+    int ok = 1;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-r") && i + 1 < argc)
+            reps = atol(argv[++i]);
+        else if (!strcmp(argv[i], "-w") && i + 1 < argc)
+            warmup = atol(argv[++i]);
+        else if (!strcmp(argv[i], "-f") && i + 1 < argc)
+            family = argv[++i];
+        else if (argv[i][0] != '-' && !poly)
+            poly = argv[i];
+        else
+        {
+            printf("Syntax: gmconnection-bench [-r reps] [-w warmup] "
+                   "[-f family | poly]\n");
+            fflush(stdout);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (family)
+    {
+        for (i = 0; i < NFAMILIES; i++)
+            if (!strcmp(family, families[i].name))
+                break;
+
+        if (i == NFAMILIES)
+        {
+            printf("Unknown family %s.  The families are", family);
+            for (i = 0; i < NFAMILIES; i++)
+                printf(" %s", families[i].name);
+            printf(".\n");
+            fflush(stdout);
+            return EXIT_FAILURE;
+        }
+    }
+
+    ctx_init_fmpz_poly_q(ctx);
+
+    printf("family\tn\td\tb\tphase\treps\tmedian\tp10\tp90\tmin\tmax\tmaxrss_kb\n");
+
+    if (poly)
+    {
+        ok = bench_family_fork("custom", poly, FLINT_MAX(reps, 1), warmup, ctx);
+    }
+    else
+    {
+        for (i = 0; i < NFAMILIES; i++)
+            if (!family || !strcmp(family, families[i].name))
+                ok &= bench_family_fork(families[i].name, families[i].poly,
+                                        (reps > 0) ? reps : families[i].reps,
+                                        warmup, ctx);
+    }
+
+    ctx_clear(ctx);
+
+    _fmpz_cleanup();
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
@@ -34,7 +34,19 @@ int main(int argc, const char* argv[])
 
     b = gmc_basis_size(n, mpoly_degree(P, -1, ctx));
     mat_init(M, b, b, ctx);
-    gmc_compute(M, &rows, &cols, P, ctx);
+
+    /* Look up M in the cache directory GMC_CACHE_DIR, if set */
+    {
+        const char *cache = getenv("GMC_CACHE_DIR");
+
+        if (!(cache && gmc_cache_load(M, &rows, &cols, NULL, P, cache, ctx)))
+        {
+            gmc_compute(M, &rows, &cols, P, ctx);
+
+            if (cache)
+                gmc_cache_store(M, rows, NULL, P, cache, ctx);
+        }
+    }
 
     {
         long i, j;
@@ -5,6 +5,12 @@
 #ifndef FLINT_EX_H
 #define FLINT_EX_H
 
+#include <stddef.h>
+
+#include "flint/flint.h"
+#include "flint/fmpz.h"
+#include "flint/fmpq_poly.h"
+
 
 void 
 _fmpz_mod_poly_compose_smod(fmpz *rop, 
@@ -13,6 +19,14 @@ _fmpz_mod_poly_compose_smod(fmpz *rop,
                            const fmpz *a, const slong *j, slong lena, 
                            const fmpz_t p);
 
+int fmpq_poly_ratrecon(fmpq_poly_t N, fmpq_poly_t D, 
+                       const fmpq_poly_t L, const fmpq_poly_t Z, long k);
+
+
+void flint_parallel_run(void *(*worker)(void *), void *args, size_t size, 
+                        long nt);
+
+long flint_parallel_num_threads(void);
 
 #endif
 
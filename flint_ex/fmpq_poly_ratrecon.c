@@ -0,0 +1,74 @@
+/******************************************************************************
+
+    Copyright (C) 2013 Sebastian Pancratz
+ 
+******************************************************************************/
+
+#include "flint/fmpq_poly.h"
+
+/*
+    Given polynomials L and Z with deg(L) < deg(Z) = m and an integer 
+    0 < k <= m, attempts to find polynomials N and D with D monic, 
+    deg(N) < k and deg(D) <= m - k such that N = D L modulo Z.
+
+    Runs the extended Euclidean algorithm on the pair (Z, L), stopping 
+    at the first remainder of degree less than k.
+
+    Returns $1$ if such polynomials are found, and $0$ otherwise.
+ */
+
+int fmpq_poly_ratrecon(fmpq_poly_t N, fmpq_poly_t D, 
+                       const fmpq_poly_t L, const fmpq_poly_t Z, long k)
+{
+    const long m = fmpq_poly_degree(Z);
+
+    fmpq_poly_t r0, r1, s0, s1, q, r;
+    fmpq_t x;
+    int ans = 1;
+
+    fmpq_poly_init(r0);
+    fmpq_poly_init(r1);
+    fmpq_poly_init(s0);
+    fmpq_poly_init(s1);
+    fmpq_poly_init(q);
+    fmpq_poly_init(r);
+    fmpq_init(x);
+
+    fmpq_poly_set(r0, Z);
+    fmpq_poly_set(r1, L);
+    fmpq_poly_zero(s0);
+    fmpq_poly_one(s1);
+
+    while (fmpq_poly_degree(r1) >= k)
+    {
+        fmpq_poly_divrem(q, r, r0, r1);
+        fmpq_poly_swap(r0, r1);
+        fmpq_poly_swap(r1, r);
+
+        fmpq_poly_mul(r, q, s1);
+        fmpq_poly_sub(r, s0, r);
+        fmpq_poly_swap(s0, s1);
+        fmpq_poly_swap(s1, r);
+    }
+
+    if (fmpq_poly_degree(s1) > m - k)
+        ans = 0;
+
+    if (ans)
+    {
+        fmpq_poly_get_coeff_fmpq(x, s1, fmpq_poly_degree(s1));
+        fmpq_poly_scalar_div_fmpq(N, r1, x);
+        fmpq_poly_scalar_div_fmpq(D, s1, x);
+    }
+
+    fmpq_poly_clear(r0);
+    fmpq_poly_clear(r1);
+    fmpq_poly_clear(s0);
+    fmpq_poly_clear(s1);
+    fmpq_poly_clear(q);
+    fmpq_poly_clear(r);
+    fmpq_clear(x);
+
+    return ans;
+}
+
@@ -0,0 +1,117 @@
+/******************************************************************************
+
+    Copyright (C) 2013 Sebastian Pancratz
+ 
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "flint_ex.h"
+
+/*
+    Each worker runs with its share of the thread budget of the caller, 
+    as given by flint_parallel_num_threads(), so that the pools started 
+    by nested calls do not multiply the number of running threads.
+
+    The share is kept in a thread-local variable rather than passed to 
+    flint_set_num_threads(), which resizes FLINT's process-wide thread 
+    pool and must not be called while another thread may be using it. 
+    A budget of zero means that the thread is not running as a worker.
+ */
+static __thread long _flint_parallel_budget = 0;
+
+typedef struct
+{
+    void *(*worker)(void *);
+    void *arg;
+    long num;
+} _flint_parallel_arg_struct;
+
+static void * _flint_parallel_trampoline(void *arg_ptr)
+{
+    _flint_parallel_arg_struct *arg = arg_ptr;
+    const long num = _flint_parallel_budget;
+    void *ans;
+
+    _flint_parallel_budget = arg->num;
+    ans = arg->worker(arg->arg);
+    _flint_parallel_budget = num;
+
+    return ans;
+}
+
+long flint_parallel_num_threads(void)
+{
+    if (_flint_parallel_budget > 0)
+        return _flint_parallel_budget;
+    else
+        return FLINT_MAX(1, flint_get_num_threads());
+}
+
+/*
+    Runs worker on the nt arguments args + t size for 0 <= t < nt, 
+    the arguments 1 to nt - 1 in new threads and the argument 0 in the 
+    calling thread, and returns once all of them have finished.
+
+    The flint_parallel_num_threads() threads available to the caller 
+    are split evenly between the nt workers, each of which sees at 
+    least one thread through flint_parallel_num_threads().
+
+    If a thread cannot be created, its argument is processed by the 
+    calling thread instead, so that no work is ever skipped.  Workers 
+    claiming their work from a shared counter simply see fewer threads.
+ */
+
+void flint_parallel_run(void *(*worker)(void *), void *args, size_t size, 
+                        long nt)
+{
+    const long total = flint_parallel_num_threads();
+    char *a = args;
+    _flint_parallel_arg_struct *w;
+    pthread_t *threads;
+    int *started;
+    long t;
+
+    if (nt <= 1)
+    {
+        worker(a);
+        return;
+    }
+
+    w       = malloc(nt * sizeof(_flint_parallel_arg_struct));
+    threads = malloc(nt * sizeof(pthread_t));
+    started = malloc(nt * sizeof(int));
+    if (!w || !threads || !started)
+    {
+        printf("ERROR (flint_parallel_run).  Memory allocation.\n\n");
+        abort();
+    }
+
+    for (t = 0; t < nt; t++)
+    {
+        w[t].worker = worker;
+        w[t].arg    = a + t * size;
+        w[t].num    = FLINT_MAX(1, total / nt + (t < total % nt));
+    }
+
+    for (t = 1; t < nt; t++)
+    {
+        started[t] = !pthread_create(threads + t, NULL, 
+                                     _flint_parallel_trampoline, w + t);
+        if (!started[t])
+            _flint_parallel_trampoline(w + t);
+    }
+
+    _flint_parallel_trampoline(w + 0);
+
+    for (t = 1; t < nt; t++)
+        if (started[t])
+            pthread_join(threads[t], NULL);
+
+    free(w);
+    free(threads);
+    free(started);
+}
+
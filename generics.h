@@ -17,6 +17,7 @@
 
 #include "flint/fmpq_poly.h"
 #include "flint/fmpz_poly_q.h"
+#include "flint/nmod_poly.h"
 #include "flint/padic.h"
 #include "flint/padic_poly.h"
 
@@ -55,8 +56,18 @@ typedef struct __ctx_struct
     char * (*get_str)(const struct __ctx_struct * ctx, const void *op);
     int (*set_str)(const struct __ctx_struct * ctx, void *rop, const char * str);
 
+    /*
+        Binary serialisation of a single element, in a format specific 
+        to the context;  both return non-zero on success and zero on 
+        failure, and either may be NULL
+     */
+    int (*out_raw)(const struct __ctx_struct * ctx, FILE *file, const void *op);
+    int (*inp_raw)(const struct __ctx_struct * ctx, void *rop, FILE *file);
+
     padic_ctx_struct *pctx;
 
+    nmod_t mod;   /* Modulus, for contexts over Z/nZ */
+
 } __ctx_struct;
 
 typedef __ctx_struct ctx_t[1];
@@ -135,6 +146,10 @@ static char * ld_get_str(const struct __ctx_struct * ctx, const void *op)
     sprintf(s, "%ld", *(long *) op);
     return s;
 }
+static int ld_out_raw(const struct __ctx_struct * ctx, FILE *file, const void *op)
+    { return fwrite(op, sizeof(long), 1, file) == 1; }
+static int ld_inp_raw(const struct __ctx_struct * ctx, void *rop, FILE *file)
+    { return fread(rop, sizeof(long), 1, file) == 1; }
 static int ld_set_str(const struct __ctx_struct * ctx, void *rop, const char *str)
 {
     *(long *) rop = atoi(str);
@@ -166,6 +181,8 @@ static void ctx_init_long(ctx_t ctx)
     ctx->print             = &ld_print;
     ctx->get_str           = &ld_get_str;
     ctx->set_str           = &ld_set_str;
+    ctx->out_raw           = &ld_out_raw;
+    ctx->inp_raw           = &ld_inp_raw;
 }
 
 /* mpq_t **********************************************************************/
@@ -221,6 +238,16 @@ static char * _mpq_get_str(const struct __ctx_struct * ctx, const void *op)
     { return mpq_get_str(NULL, 10, op); }
 static int _mpq_set_str(const struct __ctx_struct * ctx, void *rop, const char *str)
     { return (mpq_set_str(rop, str, 10) == 0) ? 1 : 0; }
+static int _mpq_out_raw(const struct __ctx_struct * ctx, FILE *file, const void *op)
+{
+    return mpz_out_raw(file, mpq_numref((const __mpq_struct *) op)) > 0 
+        && mpz_out_raw(file, mpq_denref((const __mpq_struct *) op)) > 0;
+}
+static int _mpq_inp_raw(const struct __ctx_struct * ctx, void *rop, FILE *file)
+{
+    return mpz_inp_raw(mpq_numref((__mpq_struct *) rop), file) > 0 
+        && mpz_inp_raw(mpq_denref((__mpq_struct *) rop), file) > 0;
+}
 
 static void ctx_init_mpq(ctx_t ctx)
 {
@@ -247,6 +274,8 @@ static void ctx_init_mpq(ctx_t ctx)
     ctx->print             = &_mpq_print;
     ctx->get_str           = &_mpq_get_str;
     ctx->set_str           = &_mpq_set_str;
+    ctx->out_raw           = &_mpq_out_raw;
+    ctx->inp_raw           = &_mpq_inp_raw;
 }
 
 /* Polynomials over Z ********************************************************/
@@ -305,6 +334,44 @@ static char * __fmpz_poly_get_str(const struct __ctx_struct * ctx, const void *o
 static int __fmpz_poly_set_str(const struct __ctx_struct * ctx, void *rop, const char *str)
     { return fmpz_poly_set_str(rop, str); }
 
+/* 
+    Writes the length followed by the coefficients in the format of 
+    fmpz_out_raw().  The readers of this and the other raw formats below 
+    only allocate space for the coefficients as they are actually read, 
+    so that a corrupt length leads to a failed read rather than to an 
+    excessive allocation.
+ */
+static int _fmpz_poly_out_raw(FILE *file, const fmpz_poly_t op)
+{
+    long i;
+    int ok = fwrite(&(op->length), sizeof(long), 1, file) == 1;
+
+    for (i = 0; ok && i < op->length; i++)
+        ok = fmpz_out_raw(file, op->coeffs + i) > 0;
+    return ok;
+}
+static int _fmpz_poly_inp_raw(fmpz_poly_t rop, FILE *file)
+{
+    long i, len;
+    int ok = fread(&len, sizeof(long), 1, file) == 1 && len >= 0;
+
+    if (ok)
+    {
+        for (i = 0; ok && i < len; i++)
+        {
+            fmpz_poly_fit_length(rop, i + 1);
+            ok = fmpz_inp_raw(rop->coeffs + i, file) > 0;
+        }
+        _fmpz_poly_set_length(rop, ok ? len : i);
+        _fmpz_poly_normalise(rop);
+    }
+    return ok;
+}
+static int __fmpz_poly_out_raw(const struct __ctx_struct * ctx, FILE *file, const void *op)
+    { return _fmpz_poly_out_raw(file, op); }
+static int __fmpz_poly_inp_raw(const struct __ctx_struct * ctx, void *rop, FILE *file)
+    { return _fmpz_poly_inp_raw(rop, file); }
+
 static void ctx_init_fmpz_poly(ctx_t ctx)
 {
     ctx->size              = sizeof(fmpz_poly_struct);
@@ -330,6 +397,8 @@ static void ctx_init_fmpz_poly(ctx_t ctx)
     ctx->print             = &__fmpz_poly_print;
     ctx->get_str           = &__fmpz_poly_get_str;
     ctx->set_str           = &__fmpz_poly_set_str;
+    ctx->out_raw           = &__fmpz_poly_out_raw;
+    ctx->inp_raw           = &__fmpz_poly_inp_raw;
 }
 
 /* Polynomials over Q ********************************************************/
@@ -387,6 +456,39 @@ static char * __fmpq_poly_get_str(const struct __ctx_struct * ctx, const void *o
     { return fmpq_poly_get_str(op); }
 static int __fmpq_poly_set_str(const struct __ctx_struct * ctx, void *rop, const char *str)
     { return fmpq_poly_set_str(rop, str); }
+static int __fmpq_poly_out_raw(const struct __ctx_struct * ctx, FILE *file, const void *op)
+{
+    const fmpq_poly_struct *x = op;
+    long i;
+    int ok = fwrite(&(x->length), sizeof(long), 1, file) == 1 
+          && fmpz_out_raw(file, x->den) > 0;
+
+    for (i = 0; ok && i < x->length; i++)
+        ok = fmpz_out_raw(file, x->coeffs + i) > 0;
+    return ok;
+}
+static int __fmpq_poly_inp_raw(const struct __ctx_struct * ctx, void *rop, FILE *file)
+{
+    fmpq_poly_struct *x = rop;
+    long i, len;
+    int ok = fread(&len, sizeof(long), 1, file) == 1 && len >= 0;
+
+    if (ok)
+    {
+        ok = fmpz_inp_raw(x->den, file) > 0 && !fmpz_is_zero(x->den);
+        for (i = 0; ok && i < len; i++)
+        {
+            fmpq_poly_fit_length(x, i + 1);
+            ok = fmpz_inp_raw(x->coeffs + i, file) > 0;
+        }
+        _fmpq_poly_set_length(x, ok ? len : 0);
+        if (ok)
+            fmpq_poly_canonicalise(x);
+        else
+            fmpq_poly_zero(x);
+    }
+    return ok;
+}
 
 static void ctx_init_fmpq_poly(ctx_t ctx)
 {
@@ -413,6 +515,8 @@ static void ctx_init_fmpq_poly(ctx_t ctx)
     ctx->print             = &__fmpq_poly_print;
     ctx->get_str           = &__fmpq_poly_get_str;
     ctx->set_str           = &__fmpq_poly_set_str;
+    ctx->out_raw           = &__fmpq_poly_out_raw;
+    ctx->inp_raw           = &__fmpq_poly_inp_raw;
 }
 
 /* Rational functions ********************************************************/
@@ -472,6 +576,21 @@ static char * _fmpz_poly_q_get_str(const struct __ctx_struct * ctx, const void *
     { return fmpz_poly_q_get_str(op); }
 static int _fmpz_poly_q_set_str(const struct __ctx_struct * ctx, void *rop, const char *str)
     { return fmpz_poly_q_set_str(rop, str); }
+static int _fmpz_poly_q_out_raw(const struct __ctx_struct * ctx, FILE *file, const void *op)
+{
+    return _fmpz_poly_out_raw(file, ((const fmpz_poly_q_struct *) op)->num) 
+        && _fmpz_poly_out_raw(file, ((const fmpz_poly_q_struct *) op)->den);
+}
+static int _fmpz_poly_q_inp_raw(const struct __ctx_struct * ctx, void *rop, FILE *file)
+{
+    fmpz_poly_q_struct *x = rop;
+    int ok = _fmpz_poly_inp_raw(x->num, file) && _fmpz_poly_inp_raw(x->den, file) 
+          && !fmpz_poly_is_zero(x->den);
+
+    if (!ok)
+        fmpz_poly_q_zero(x);
+    return ok;
+}
 
 static void ctx_init_fmpz_poly_q(ctx_t ctx)
 {
@@ -498,7 +617,348 @@ static void ctx_init_fmpz_poly_q(ctx_t ctx)
     ctx->print             = &_fmpz_poly_q_print;
     ctx->get_str           = &_fmpz_poly_q_get_str;
     ctx->set_str           = &_fmpz_poly_q_set_str;
+    ctx->out_raw           = &_fmpz_poly_q_out_raw;
+    ctx->inp_raw           = &_fmpz_poly_q_inp_raw;
 }
 
-#endif
+/* Rational functions over Z/nZ **********************************************/
+
+/*
+    Elements are kept in canonical form, that is, with coprime numerator 
+    and denominator and with the denominator monic.  The modulus is 
+    assumed to be prime.
+ */
+typedef struct
+{
+    nmod_poly_struct num;
+    nmod_poly_struct den;
+} nmod_poly_q_struct;
+
+static void _nmod_poly_q_canonicalise(nmod_poly_q_struct *rop)
+{
+    if (nmod_poly_is_zero(&rop->num))
+    {
+        nmod_poly_one(&rop->den);
+    }
+    else
+    {
+        nmod_poly_t g;
+        mp_limb_t c;
+
+        nmod_poly_init_preinv(g, rop->den.mod.n, rop->den.mod.ninv);
+        nmod_poly_gcd(g, &rop->num, &rop->den);
+        if (nmod_poly_length(g) > 1)
+        {
+            nmod_poly_div(&rop->num, &rop->num, g);
+            nmod_poly_div(&rop->den, &rop->den, g);
+        }
+        nmod_poly_clear(g);
+
+        c = nmod_poly_get_coeff_ui(&rop->den, nmod_poly_degree(&rop->den));
+        if (c != 1)
+        {
+            c = n_invmod(c, rop->den.mod.n);
+            nmod_poly_scalar_mul_nmod(&rop->num, &rop->num, c);
+            nmod_poly_scalar_mul_nmod(&rop->den, &rop->den, c);
+        }
+    }
+}
+
+static void _nmod_poly_q_init(const struct __ctx_struct * ctx, void *rop)
+{
+    nmod_poly_init_preinv(&((nmod_poly_q_struct *) rop)->num, ctx->mod.n, ctx->mod.ninv);
+    nmod_poly_init_preinv(&((nmod_poly_q_struct *) rop)->den, ctx->mod.n, ctx->mod.ninv);
+    nmod_poly_one(&((nmod_poly_q_struct *) rop)->den);
+}
+static void _nmod_poly_q_clear(const struct __ctx_struct * ctx, void *rop)
+{
+    nmod_poly_clear(&((nmod_poly_q_struct *) rop)->num);
+    nmod_poly_clear(&((nmod_poly_q_struct *) rop)->den);
+}
+
+static void _nmod_poly_q_set(const struct __ctx_struct * ctx, void *rop, const void *op)
+{
+    nmod_poly_set(&((nmod_poly_q_struct *) rop)->num, &((const nmod_poly_q_struct *) op)->num);
+    nmod_poly_set(&((nmod_poly_q_struct *) rop)->den, &((const nmod_poly_q_struct *) op)->den);
+}
+static void _nmod_poly_q_set_si(const struct __ctx_struct * ctx, void *rop, long op)
+{
+    mp_limb_t c = (op >= 0) ? n_mod2_preinv(op, ctx->mod.n, ctx->mod.ninv) : 
+                  nmod_neg(n_mod2_preinv(- (mp_limb_t) op, ctx->mod.n, ctx->mod.ninv), ctx->mod);
+
+    nmod_poly_zero(&((nmod_poly_q_struct *) rop)->num);
+    nmod_poly_set_coeff_ui(&((nmod_poly_q_struct *) rop)->num, 0, c);
+    nmod_poly_one(&((nmod_poly_q_struct *) rop)->den);
+}
+static void _nmod_poly_q_swap(const struct __ctx_struct * ctx, void *op1, void *op2)
+{
+    nmod_poly_swap(&((nmod_poly_q_struct *) op1)->num, &((nmod_poly_q_struct *) op2)->num);
+    nmod_poly_swap(&((nmod_poly_q_struct *) op1)->den, &((nmod_poly_q_struct *) op2)->den);
+}
+static void _nmod_poly_q_zero(const struct __ctx_struct * ctx, void *rop)
+{
+    nmod_poly_zero(&((nmod_poly_q_struct *) rop)->num);
+    nmod_poly_one(&((nmod_poly_q_struct *) rop)->den);
+}
+static void _nmod_poly_q_one(const struct __ctx_struct * ctx, void *rop)
+{
+    nmod_poly_one(&((nmod_poly_q_struct *) rop)->num);
+    nmod_poly_one(&((nmod_poly_q_struct *) rop)->den);
+}
+
+static void _nmod_poly_q_randtest(const struct __ctx_struct * ctx, void *rop, flint_rand_t state)
+{
+    nmod_poly_randtest(&((nmod_poly_q_struct *) rop)->num, state, n_randint(state, 10));
+    nmod_poly_randtest_not_zero(&((nmod_poly_q_struct *) rop)->den, state, n_randint(state, 9) + 1);
+    _nmod_poly_q_canonicalise(rop);
+}
+static void _nmod_poly_q_randtest_not_zero(const struct __ctx_struct * ctx, void *rop, flint_rand_t state)
+{
+    nmod_poly_randtest_not_zero(&((nmod_poly_q_struct *) rop)->num, state, n_randint(state, 9) + 1);
+    nmod_poly_randtest_not_zero(&((nmod_poly_q_struct *) rop)->den, state, n_randint(state, 9) + 1);
+    _nmod_poly_q_canonicalise(rop);
+}
+
+static int _nmod_poly_q_equal(const struct __ctx_struct * ctx, const void *op1, const void *op2)
+{
+    return nmod_poly_equal(&((const nmod_poly_q_struct *) op1)->num, &((const nmod_poly_q_struct *) op2)->num) 
+        && nmod_poly_equal(&((const nmod_poly_q_struct *) op1)->den, &((const nmod_poly_q_struct *) op2)->den);
+}
+static int _nmod_poly_q_is_zero(const struct __ctx_struct * ctx, const void *op)
+    { return nmod_poly_is_zero(&((const nmod_poly_q_struct *) op)->num); }
+static int _nmod_poly_q_is_one(const struct __ctx_struct * ctx, const void *op)
+{
+    return nmod_poly_is_one(&((const nmod_poly_q_struct *) op)->num) 
+        && nmod_poly_is_one(&((const nmod_poly_q_struct *) op)->den);
+}
+
+static void _nmod_poly_q_neg(const struct __ctx_struct * ctx, void *rop, const void *op)
+{
+    nmod_poly_neg(&((nmod_poly_q_struct *) rop)->num, &((const nmod_poly_q_struct *) op)->num);
+    nmod_poly_set(&((nmod_poly_q_struct *) rop)->den, &((const nmod_poly_q_struct *) op)->den);
+}
+
+static void _nmod_poly_q_addsub(const struct __ctx_struct * ctx, void *rop, const void *op1, const void *op2, int sub)
+{
+    const nmod_poly_q_struct *x = op1, *y = op2;
+    nmod_poly_q_struct *z = rop;
+    nmod_poly_t s, t, u;
+
+    nmod_poly_init_preinv(s, ctx->mod.n, ctx->mod.ninv);
+    nmod_poly_init_preinv(t, ctx->mod.n, ctx->mod.ninv);
+    nmod_poly_init_preinv(u, ctx->mod.n, ctx->mod.ninv);
+
+    nmod_poly_mul(s, &x->num, &y->den);
+    nmod_poly_mul(t, &y->num, &x->den);
+    if (sub)
+        nmod_poly_sub(s, s, t);
+    else
+        nmod_poly_add(s, s, t);
+    nmod_poly_mul(u, &x->den, &y->den);
+
+    nmod_poly_swap(&z->num, s);
+    nmod_poly_swap(&z->den, u);
+    _nmod_poly_q_canonicalise(z);
+
+    nmod_poly_clear(s);
+    nmod_poly_clear(t);
+    nmod_poly_clear(u);
+}
+static void _nmod_poly_q_add(const struct __ctx_struct * ctx, void *rop, const void *op1, const void *op2)
+    { _nmod_poly_q_addsub(ctx, rop, op1, op2, 0); }
+static void _nmod_poly_q_sub(const struct __ctx_struct * ctx, void *rop, const void *op1, const void *op2)
+    { _nmod_poly_q_addsub(ctx, rop, op1, op2, 1); }
+
+static void _nmod_poly_q_muldiv(const struct __ctx_struct * ctx, void *rop, const void *op1, const void *op2, int div)
+{
+    const nmod_poly_q_struct *x = op1, *y = op2;
+    nmod_poly_q_struct *z = rop;
+    nmod_poly_t s, t;
+
+    nmod_poly_init_preinv(s, ctx->mod.n, ctx->mod.ninv);
+    nmod_poly_init_preinv(t, ctx->mod.n, ctx->mod.ninv);
+
+    nmod_poly_mul(s, &x->num, div ? &y->den : &y->num);
+    nmod_poly_mul(t, &x->den, div ? &y->num : &y->den);
 
+    nmod_poly_swap(&z->num, s);
+    nmod_poly_swap(&z->den, t);
+    _nmod_poly_q_canonicalise(z);
+
+    nmod_poly_clear(s);
+    nmod_poly_clear(t);
+}
+static void _nmod_poly_q_mul(const struct __ctx_struct * ctx, void *rop, const void *op1, const void *op2)
+    { _nmod_poly_q_muldiv(ctx, rop, op1, op2, 0); }
+static void _nmod_poly_q_div(const struct __ctx_struct * ctx, void *rop, const void *op1, const void *op2)
+    { _nmod_poly_q_muldiv(ctx, rop, op1, op2, 1); }
+
+static void _nmod_poly_q_derivative(const struct __ctx_struct * ctx, void *rop, const void *op)
+{
+    const nmod_poly_q_struct *x = op;
+    nmod_poly_q_struct *z = rop;
+    nmod_poly_t s, t, u;
+
+    nmod_poly_init_preinv(s, ctx->mod.n, ctx->mod.ninv);
+    nmod_poly_init_preinv(t, ctx->mod.n, ctx->mod.ninv);
+    nmod_poly_init_preinv(u, ctx->mod.n, ctx->mod.ninv);
+
+    nmod_poly_derivative(s, &x->num);
+    nmod_poly_mul(s, s, &x->den);
+    nmod_poly_derivative(t, &x->den);
+    nmod_poly_mul(t, t, &x->num);
+    nmod_poly_sub(s, s, t);
+    nmod_poly_mul(u, &x->den, &x->den);
+
+    nmod_poly_swap(&z->num, s);
+    nmod_poly_swap(&z->den, u);
+    _nmod_poly_q_canonicalise(z);
+
+    nmod_poly_clear(s);
+    nmod_poly_clear(t);
+    nmod_poly_clear(u);
+}
+
+static int _nmod_poly_q_print(const struct __ctx_struct * ctx, const void *op)
+{
+    const nmod_poly_q_struct *x = op;
+
+    if (nmod_poly_is_one(&x->den))
+        return nmod_poly_print(&x->num);
+
+    printf("(");
+    nmod_poly_print(&x->num);
+    printf(")/(");
+    nmod_poly_print(&x->den);
+    printf(")");
+    return 1;
+}
+static char * _nmod_poly_q_get_str(const struct __ctx_struct * ctx, const void *op)
+{
+    const nmod_poly_q_struct *x = op;
+    char *s, *t, *u;
+
+    s = nmod_poly_get_str(&x->num);
+    if (nmod_poly_is_one(&x->den))
+        return s;
+
+    t = nmod_poly_get_str(&x->den);
+    u = flint_malloc(strlen(s) + strlen(t) + 2);
+    sprintf(u, "%s/%s", s, t);
+    flint_free(s);
+    flint_free(t);
+    return u;
+}
+/*
+    Reads the numerator and, optionally after a slash, the denominator 
+    in the format of nmod_poly_set_str().  As for the other contexts, 
+    returns zero on success.
+ */
+static int _nmod_poly_q_set_str(const struct __ctx_struct * ctx, void *rop, const char *str)
+{
+    nmod_poly_q_struct *x = rop;
+    const char *q = strchr(str, '/');
+    int ok;
+
+    if (q)
+    {
+        char *s = flint_malloc(q - str + 1);
+
+        memcpy(s, str, q - str);
+        s[q - str] = '\0';
+        ok = nmod_poly_set_str(&x->num, s) && nmod_poly_set_str(&x->den, q + 1);
+        flint_free(s);
+    }
+    else
+    {
+        ok = nmod_poly_set_str(&x->num, str);
+        nmod_poly_one(&x->den);
+    }
+    if (ok)
+        _nmod_poly_q_canonicalise(x);
+    return !ok;
+}
+
+/* Writes the length followed by the coefficients as limbs */
+static int _nmod_poly_out_raw(FILE *file, const nmod_poly_t op)
+{
+    return fwrite(&(op->length), sizeof(long), 1, file) == 1 
+        && fwrite(op->coeffs, sizeof(mp_limb_t), op->length, file) 
+           == (size_t) op->length;
+}
+static int _nmod_poly_inp_raw(nmod_poly_t rop, FILE *file)
+{
+    long i, j, k, len;
+    int ok = fread(&len, sizeof(long), 1, file) == 1 && len >= 0;
+
+    if (ok)
+    {
+        /* Read in chunks of at most the length read so far */
+        for (i = 0; ok && i < len; i += k)
+        {
+            k = FLINT_MIN(len - i, FLINT_MAX(i, 16));
+            nmod_poly_fit_length(rop, i + k);
+            ok = fread(rop->coeffs + i, sizeof(mp_limb_t), k, file) == (size_t) k;
+            for (j = i; ok && j < i + k; j++)
+                ok = (rop->coeffs[j] < rop->mod.n);
+        }
+        rop->length = ok ? len : 0;
+        _nmod_poly_normalise(rop);
+    }
+    return ok;
+}
+static int _nmod_poly_q_out_raw(const struct __ctx_struct * ctx, FILE *file, const void *op)
+{
+    const nmod_poly_q_struct *x = op;
+
+    return _nmod_poly_out_raw(file, &x->num) && _nmod_poly_out_raw(file, &x->den);
+}
+static int _nmod_poly_q_inp_raw(const struct __ctx_struct * ctx, void *rop, FILE *file)
+{
+    nmod_poly_q_struct *x = rop;
+    int ok = _nmod_poly_inp_raw(&x->num, file) && _nmod_poly_inp_raw(&x->den, file) 
+          && !nmod_poly_is_zero(&x->den);
+
+    if (!ok)
+    {
+        nmod_poly_zero(&x->num);
+        nmod_poly_one(&x->den);
+    }
+    return ok;
+}
+
+/*
+    Rational functions over Z/nZ, for a prime n.
+ */
+static void ctx_init_nmod_poly_q(ctx_t ctx, mp_limb_t n)
+{
+    ctx->size              = sizeof(nmod_poly_q_struct);
+
+    nmod_init(&(ctx->mod), n);
+
+    ctx->init              = &_nmod_poly_q_init;
+    ctx->clear             = &_nmod_poly_q_clear;
+    ctx->set               = &_nmod_poly_q_set;
+    ctx->set_si            = &_nmod_poly_q_set_si;
+    ctx->swap              = &_nmod_poly_q_swap;
+    ctx->zero              = &_nmod_poly_q_zero;
+    ctx->one               = &_nmod_poly_q_one;
+    ctx->randtest          = &_nmod_poly_q_randtest;
+    ctx->randtest_not_zero = &_nmod_poly_q_randtest_not_zero;
+    ctx->equal             = &_nmod_poly_q_equal;
+    ctx->is_zero           = &_nmod_poly_q_is_zero;
+    ctx->is_one            = &_nmod_poly_q_is_one;
+    ctx->neg               = &_nmod_poly_q_neg;
+    ctx->add               = &_nmod_poly_q_add;
+    ctx->sub               = &_nmod_poly_q_sub;
+    ctx->mul               = &_nmod_poly_q_mul;
+    ctx->div               = &_nmod_poly_q_div;
+    ctx->derivative        = &_nmod_poly_q_derivative;
+    ctx->print             = &_nmod_poly_q_print;
+    ctx->get_str           = &_nmod_poly_q_get_str;
+    ctx->set_str           = &_nmod_poly_q_set_str;
+    ctx->out_raw           = &_nmod_poly_q_out_raw;
+    ctx->inp_raw           = &_nmod_poly_q_inp_raw;
+}
+
+#endif
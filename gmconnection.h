@@ -12,6 +12,7 @@
 #include <gmp.h>
 #include "flint/flint.h"
 #include "flint/fmpz.h"
+#include "flint/fmpq.h"
 #include "flint/fmpz_poly.h"
 #include "flint/fmpz_poly_q.h"
 #include "flint/fmpz_poly_mat.h"
@@ -22,6 +23,108 @@
 #include "vec.h"
 #include "mpoly.h"
 
+/*
+    Dense representation of the homogeneous polynomials of degree 
+    k d - (n + 1) in the variables X_0, ..., X_n, that is, of the 
+    numerators of pole order k in the Griffiths--Dwork reduction.
+ */
+typedef struct
+{
+    long n;
+    long d;
+    long k;
+
+    long len;       /* Number of monomials of degree k d - (n + 1) */
+    mon_t *mon;     /* Unrank table, in inverse lexicographical order */
+
+    long lenB;      /* Ranks of the monomials in the basis */
+    long *B;
+    long lenN;      /* Ranks of the monomials not in the basis */
+    long *N;
+
+    /*
+        Index operators for the columns of the auxiliary matrix at level 
+        k, if any, where column j corresponds to the monomial cols[j] in 
+        the block of the variable X_var
+     */
+    long ncols;
+    long *dpos;     /* Rank of d/dX_var cols[j] at level k - 1, or -1 */
+    long *dexp;     /* Exponent of X_var in cols[j] */
+    long *mulp;     /* Pointers into muli and mulx, of length ncols + 1 */
+    long *muli;     /* Basis indices of the terms of cols[j] dP_var */
+    char *mulx;     /* Coefficients of these terms */
+} __gmc_level_struct;
+
+typedef __gmc_level_struct gmc_level_t[1];
+
+/*
+    Data for the computation of the Gauss--Manin connection which only 
+    depends on the supports of the partial derivatives of P, namely the 
+    index sets, the levels with their operators, and the auxiliary 
+    matrices with their solve structures.
+
+    The values of the auxiliary matrices and of the multiplication 
+    operators are refilled for each polynomial from the arrays of 
+    sources, which give one plus the index of the corresponding term 
+    in the list D of the terms of all partial derivatives.
+ */
+typedef struct
+{
+    int built;      /* Whether the remaining fields are set */
+    long n;
+    long d;
+    int ff;
+
+    long lenD;      /* Terms of dP/dX_0, ..., dP/dX_n */
+    long *iD;       /* Offsets of the variables, of length n + 2 */
+    mon_t *D;
+
+    mon_t *B;
+    long *iB;
+    long lenB, l, u, k0;
+
+    gmc_level_t *L;         /* Levels 0, ..., u + 1 */
+    long **mulsrc;          /* Sources of L[k]->mulx */
+
+    mat_csr_t *aux;         /* Auxiliary matrices, for k0 <= k <= u + 1 */
+    long **auxsrc;          /* Sources of aux[k]->x */
+    mon_t **aux_rows;
+    mon_t **aux_cols;
+    long **aux_p;
+    mat_csr_solve_t *aux_s;
+
+    char *vals;             /* Values of D for which aux_s was factored */
+
+    /*
+        Memoised reductions for the lenT monomials T of dP/dt, as in 
+        _gmc_compute_cached(), with slot set to NULL if there are none
+     */
+    long lenT;
+    mon_t *T;
+    long **slot;
+    long *imgk;
+    long *imgr;
+    long nimg;
+    char *img;
+
+    double *time;           /* Optional phase timers, or NULL */
+} __gmc_symbolic_struct;
+
+typedef __gmc_symbolic_struct gmc_symbolic_t[1];
+
+/* Phases of _gmc_compute_cached() timed in the array S->time */
+#define GMC_PHASE_SETUP   0
+#define GMC_PHASE_AUX     1
+#define GMC_PHASE_IMAGE   2
+#define GMC_PHASE_REDUCE  3
+#define GMC_NPHASES       4
+
+/* Magic bytes at the start of the files in the connection cache */
+#define GMC_CACHE_MAGIC  "GMC\001"
+
+/* Largest number of columns reduced together at one pole order */
+#define GMC_REDUCE_BATCH  8
+
 long gmc_basis_size(long n, long d);
 
 void gmc_basis_sets(mon_t **B, long **iB, long *lenB, long *l, long *u, 
@@ -31,6 +134,11 @@ int gmc_basis_contains(const mpoly_t f, long d);
 
 void gmc_basis_print(const mon_t *B, const long *iB, long lenB, long n, long d);
 
+void _gmc_init_auxmatrix(mat_csr_t M, 
+                         mon_t **R, mon_t **C, long *p, 
+                         mpoly_t *DP, long d, long k, 
+                         const ctx_t ctx);
+
 void gmc_init_auxmatrix(mat_csr_t M, 
                         mon_t **R, mon_t **C, long *p, 
                         const mpoly_t P, long k, 
@@ -42,6 +150,15 @@ void gmc_array2poly(mpoly_t poly, const char *c, const mon_t *m, long len,
 void gmc_poly2array(char *c, const mpoly_t poly, const mon_t *m, long len, 
                     const ctx_t ctx);
 
+long _gmc_decompose_poly_worklen(const mat_csr_solve_t s);
+
+void _gmc_decompose_poly(mpoly_t * A, const mpoly_t poly, 
+                         const mat_csr_solve_t s, 
+                         mon_t * const rows, 
+                         mon_t * const cols, 
+                         long * const p, 
+                         char *W, const ctx_t ctx);
+
 void gmc_decompose_poly(mpoly_t * A, const mpoly_t poly, 
                         const mat_csr_solve_t s, 
                         mon_t * const rows, 
@@ -49,6 +166,13 @@ void gmc_decompose_poly(mpoly_t * A, const mpoly_t poly,
                         long * const p, 
                         const ctx_t ctx);
 
+void gmc_decompose_polys(mpoly_t ** A, const mpoly_t * polys, long r, 
+                         const mat_csr_solve_t s, 
+                         mon_t * const rows, 
+                         mon_t * const cols, 
+                         long * const p, 
+                         const ctx_t ctx);
+
 void gmc_reduce(mpoly_t *R, 
                 const mpoly_t Q, long k, long d, mpoly_t *dP, 
                 mat_csr_solve_t *s, 
@@ -56,11 +180,82 @@ void gmc_reduce(mpoly_t *R,
                 long l, long u, 
                 const ctx_t ctx);
 
+void gmc_level_init(gmc_level_t L, long n, long d, long k);
+
+void gmc_level_set_ops(gmc_level_t L, const gmc_level_t L1, mpoly_t *dP, 
+                       const mon_t *cols, const long *p, const ctx_t ctx);
+
+void gmc_level_clear(gmc_level_t L, const ctx_t ctx);
+
+long gmc_level_rank(const gmc_level_t L, mon_t m);
+
+long _gmc_reduce_dense_worklen(gmc_level_t *L, long k);
+
+long _gmc_reduce_dense_mat_worklen(gmc_level_t *L, long k, long r);
+
+void _gmc_reduce_dense_mat(char **R, const char *Q, long r, long k, 
+                           gmc_level_t *L, mat_csr_solve_t *s, 
+                           long l, long u, char *W, const ctx_t ctx);
+
+void _gmc_reduce_dense(char **R, const char *Q, long k, 
+                       gmc_level_t *L, mat_csr_solve_t *s, 
+                       long l, long u, char *W, const ctx_t ctx);
+
+void gmc_reduce_dense(char **R, const char *Q, long k, 
+                      gmc_level_t *L, mat_csr_solve_t *s, 
+                      long l, long u, const ctx_t ctx);
+
 void gmc_derivatives(mpoly_t *D, const mpoly_t P, const ctx_t ctx);
 
+void gmc_symbolic_init(gmc_symbolic_t S);
+
+void gmc_symbolic_clear(gmc_symbolic_t S, const ctx_t ctx);
+
+void _gmc_symbolic_clear_memo(gmc_symbolic_t S, const ctx_t ctx);
+
+int _gmc_compute_cached(mat_t M, mon_t **rows, mon_t **cols, 
+                        const mpoly_t P, const mpoly_t dPdt, int ff, 
+                        gmc_symbolic_t S, const ctx_t ctx);
+
+int _gmc_compute(mat_t M, mon_t **rows, mon_t **cols, 
+                 const mpoly_t P, const mpoly_t dPdt, int ff, const ctx_t ctx);
+
 void gmc_compute(mat_t M, mon_t **rows, mon_t **cols, 
                  const mpoly_t P, const ctx_t ctx);
 
+void gmc_compute_cached(mat_t M, mon_t **rows, mon_t **cols, 
+                        const mpoly_t P, gmc_symbolic_t S, const ctx_t ctx);
+
+void gmc_compute_eval(mat_t M, mon_t **rows, mon_t **cols, 
+                      const mpoly_t P, const ctx_t ctx);
+
+void gmc_compute_multimod(mat_t M, mon_t **rows, mon_t **cols, 
+                          const mpoly_t P, const ctx_t ctx);
+
+void gmc_compute_pencil(mat_t M, mon_t **rows, mon_t **cols, 
+                        const mpoly_t P, const ctx_t ctx);
+
+char * gmc_cache_key(const mpoly_t P, const ctx_t ctx);
+
+char * _gmc_cache_path(const char *dir, const char *key, const char *suffix);
+
+void _gmc_cache_normalise(mpoly_t Q, fmpq_t c, const mpoly_t P, 
+                          const ctx_t ctx);
+
+void _gmc_cache_scale(mat_t M, const mon_t *rows, const fmpq_t c, 
+                      long n, long d, const ctx_t ctx);
+
+void _gmc_cache_den(fmpz_poly_t den, const mat_t M, const ctx_t ctx);
+
+int gmc_cache_load(mat_t M, mon_t **rows, mon_t **cols, fmpz_poly_t r, 
+                   const mpoly_t P, const char *dir, const ctx_t ctx);
+
+void gmc_cache_store(const mat_t M, const mon_t *rows, const fmpz_poly_t r, 
+                     const mpoly_t P, const char *dir, const ctx_t ctx);
+
+long gmc_character_blocks(long *blk, const mon_t *B, long lenB, 
+                          const mpoly_t P, const ctx_t ctx);
+
 void gmc_convert(fmpz_poly_mat_t numM, fmpz_poly_t denM, 
                  const mat_t M, const ctx_t ctx);
 
@@ -0,0 +1,157 @@
+/******************************************************************************
+
+    Copyright (C) 2013 Sebastian Pancratz
+
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gmconnection.h"
+
+/*
+    Returns the 64-bit FNV-1a hash of the string s.
+ */
+static unsigned long long _gmc_cache_hash(const char *s)
+{
+    unsigned long long h = 14695981039346656037ULL;
+
+    for ( ; *s; s++)
+    {
+        h ^= (unsigned char) *s;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/*
+    Sets Q to the scalar multiple c P of P, with c a non-zero rational, 
+    for which the leading coefficients of the numerator and the 
+    denominator of the coefficient of the first term of Q agree.  This 
+    is the same polynomial for all non-zero rational multiples of P.
+
+    Assumes that Q and P are not aliased.
+ */
+void _gmc_cache_normalise(mpoly_t Q, fmpq_t c, const mpoly_t P, 
+                          const ctx_t ctx)
+{
+    mpoly_iter_t iter;
+    mpoly_term t;
+
+    fmpq_one(c);
+
+    mpoly_iter_init(iter, P);
+    t = mpoly_iter_next(iter);
+    mpoly_iter_clear(iter);
+
+    if (t == NULL)
+    {
+        mpoly_zero(Q, ctx);
+    }
+    else
+    {
+        const fmpz_poly_q_struct *x = (const fmpz_poly_q_struct *) t->val;
+        fmpz_poly_q_t y;
+
+        fmpq_set_fmpz_frac(c, fmpz_poly_lead(x->den), fmpz_poly_lead(x->num));
+
+        fmpz_poly_q_init(y);
+        fmpz_poly_set_fmpz(y->num, fmpq_numref(c));
+        fmpz_poly_set_fmpz(y->den, fmpq_denref(c));
+        mpoly_scalar_mul(Q, P, y, ctx);
+        fmpz_poly_q_clear(y);
+    }
+}
+
+/*
+    Given the connection matrix M for P with respect to the monomial 
+    basis rows, sets M to the connection matrix for c P, where P is a 
+    polynomial in n + 1 variables of degree d.
+
+    The basis element X^a \Omega / P^k is c^k times the one for c P, 
+    so the entry (i, j) is multiplied by c^{k_i - k_j}.
+ */
+void _gmc_cache_scale(mat_t M, const mon_t *rows, const fmpq_t c, 
+                      long n, long d, const ctx_t ctx)
+{
+    const long b = M->m;
+
+    long i, j;
+    fmpq_t e;
+    mpq_t f;
+
+    if (fmpq_is_one(c))
+        return;
+
+    fmpq_init(e);
+    mpq_init(f);
+
+    for (i = 0; i < b; i++)
+        for (j = 0; j < b; j++)
+        {
+            fmpz_poly_q_struct *x = (fmpz_poly_q_struct *) mat_entry(M, i, j, ctx);
+            const long ki = (mon_degree(rows[i]) + (n + 1)) / d;
+            const long kj = (mon_degree(rows[j]) + (n + 1)) / d;
+
+            if (ki != kj && !fmpz_poly_q_is_zero(x))
+            {
+                fmpq_pow_si(e, c, ki - kj);
+                fmpq_get_mpq(f, e);
+                fmpz_poly_q_scalar_mul_mpq(x, x, f);
+            }
+        }
+
+    fmpq_clear(e);
+    mpq_clear(f);
+}
+
+/*
+    Sets den to the least common multiple of the denominators of M.
+ */
+void _gmc_cache_den(fmpz_poly_t den, const mat_t M, const ctx_t ctx)
+{
+    fmpz_poly_t t;
+    long i, j;
+
+    fmpz_poly_init(t);
+    fmpz_poly_set_ui(den, 1);
+    for (i = 0; i < M->m; i++)
+        for (j = 0; j < M->n; j++)
+        {
+            fmpz_poly_lcm(t, den, fmpz_poly_q_denref(
+                (const fmpz_poly_q_struct *) mat_entry(M, i, j, ctx)));
+            fmpz_poly_swap(den, t);
+        }
+    fmpz_poly_clear(t);
+}
+
+char * gmc_cache_key(const mpoly_t P, const ctx_t ctx)
+{
+    char *key;
+    mpoly_t Q;
+    fmpq_t c;
+
+    mpoly_init(Q, P->n, ctx);
+    fmpq_init(c);
+
+    _gmc_cache_normalise(Q, c, P, ctx);
+    key = mpoly_get_str(Q, ctx);
+
+    mpoly_clear(Q, ctx);
+    fmpq_clear(c);
+    return key;
+}
+
+/*
+    Returns the path of the cache file for the key in the directory dir,
+    with the suffix appended.
+ */
+char * _gmc_cache_path(const char *dir, const char *key, const char *suffix)
+{
+    char *path = malloc(strlen(dir) + strlen(suffix) + 32);
+
+    sprintf(path, "%s/gmc-%016llx.bin%s", dir, _gmc_cache_hash(key), suffix);
+    return path;
+}
+
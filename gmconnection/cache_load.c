@@ -0,0 +1,109 @@
+/******************************************************************************
+
+    Copyright (C) 2013 Sebastian Pancratz
+
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gmconnection.h"
+
+static int _gmc_cache_read_long(long *x, FILE *f)
+{
+    return fread(x, sizeof(long), 1, f) == 1;
+}
+
+int gmc_cache_load(mat_t M, mon_t **rows, mon_t **cols, fmpz_poly_t r,
+                   const mpoly_t P, const char *dir, const ctx_t ctx)
+{
+    const long b = M->m;
+
+    mpoly_t Q;
+    fmpq_t c;
+    char *key, *path, magic[4], *str;
+    long i, j, len;
+    FILE *f;
+    int ok;
+
+    /* The file holds the matrix for the normalised polynomial c P */
+    mpoly_init(Q, P->n, ctx);
+    fmpq_init(c);
+    _gmc_cache_normalise(Q, c, P, ctx);
+
+    key  = mpoly_get_str(Q, ctx);
+    path = _gmc_cache_path(dir, key, "");
+
+    mpoly_clear(Q, ctx);
+
+    f = fopen(path, "rb");
+    if (f == NULL)
+    {
+        fmpq_clear(c);
+        free(key);
+        free(path);
+        return 0;
+    }
+
+    *rows = malloc(b * sizeof(mon_t));
+    *cols = malloc(b * sizeof(mon_t));
+
+    /* Header, and the full key to guard against hash collisions */
+    ok = fread(magic, 1, 4, f) == 4 && !memcmp(magic, GMC_CACHE_MAGIC, 4)
+      && _gmc_cache_read_long(&len, f) && len == (long) strlen(key);
+
+    if (ok)
+    {
+        str = malloc(len + 1);
+        ok  = fread(str, 1, len, f) == (size_t) len && !memcmp(str, key, len);
+        free(str);
+    }
+
+    ok = ok && _gmc_cache_read_long(&len, f) && len == b
+            && fread(*rows, sizeof(mon_t), b, f) == (size_t) b;
+
+    if (ok)
+    {
+        fmpz_poly_t t;
+
+        fmpz_poly_init(t);
+        ok = _fmpz_poly_inp_raw(r ? r : t, f);
+        fmpz_poly_clear(t);
+    }
+
+    for (i = 0; ok && i < b; i++)
+        for (j = 0; ok && j < b; j++)
+            ok = ctx->inp_raw(ctx, mat_entry(M, i, j, ctx), f);
+
+    fclose(f);
+
+    if (ok)
+    {
+        for (i = 0; i < b; i++)
+            (*cols)[i] = (*rows)[i];
+
+        if (!fmpq_is_one(c))
+        {
+            fmpq_inv(c, c);
+            _gmc_cache_scale(M, *rows, c, P->n - 1, 
+                             mpoly_degree(P, -1, ctx), ctx);
+            if (r)
+                _gmc_cache_den(r, M, ctx);
+        }
+    }
+    else
+    {
+        mat_zero(M, ctx);
+        free(*rows);
+        free(*cols);
+        *rows = NULL;
+        *cols = NULL;
+    }
+
+    fmpq_clear(c);
+    free(key);
+    free(path);
+    return ok;
+}
+
@@ -0,0 +1,93 @@
+/******************************************************************************
+
+    Copyright (C) 2013 Sebastian Pancratz
+
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "gmconnection.h"
+
+static int _gmc_cache_write_long(FILE *f, long x)
+{
+    return fwrite(&x, sizeof(long), 1, f) == 1;
+}
+
+void gmc_cache_store(const mat_t M, const mon_t *rows, const fmpz_poly_t r,
+                     const mpoly_t P, const char *dir, const ctx_t ctx)
+{
+    const long b = M->m;
+
+    mpoly_t Q;
+    fmpq_t c;
+    mat_t N;
+    fmpz_poly_t den;
+    char *key, *path, *tmp, suffix[32];
+    long i, j;
+    FILE *f;
+    int ok;
+
+    /*
+        The file holds the matrix for the normalised polynomial c P, 
+        whose common denominator generally differs from r unless c = 1
+     */
+    mpoly_init(Q, P->n, ctx);
+    fmpq_init(c);
+    _gmc_cache_normalise(Q, c, P, ctx);
+
+    key  = mpoly_get_str(Q, ctx);
+    path = _gmc_cache_path(dir, key, "");
+
+    mat_init(N, b, b, ctx);
+    mat_set(N, M, ctx);
+    _gmc_cache_scale(N, rows, c, P->n - 1, mpoly_degree(P, -1, ctx), ctx);
+
+    fmpz_poly_init(den);
+    if (r && fmpq_is_one(c))
+        fmpz_poly_set(den, r);
+    else
+        _gmc_cache_den(den, N, ctx);
+
+    /*
+        Write to a temporary file private to this process and then
+        rename it into place, which is atomic, so that concurrent
+        readers never see a partial file;  concurrent writers of the
+        same key produce identical files, of which the last one wins.
+     */
+    sprintf(suffix, ".%ld.tmp", (long) getpid());
+    tmp = _gmc_cache_path(dir, key, suffix);
+
+    f = fopen(tmp, "wb");
+    if (f != NULL)
+    {
+        ok = fwrite(GMC_CACHE_MAGIC, 1, 4, f) == 4
+          && _gmc_cache_write_long(f, strlen(key))
+          && fwrite(key, 1, strlen(key), f) == strlen(key)
+          && _gmc_cache_write_long(f, b)
+          && fwrite(rows, sizeof(mon_t), b, f) == (size_t) b
+          && _fmpz_poly_out_raw(f, den);
+
+        for (i = 0; ok && i < b; i++)
+            for (j = 0; ok && j < b; j++)
+                ok = ctx->out_raw(ctx, f, mat_entry(N, i, j, ctx));
+
+        ok = (fflush(f) == 0) && ok;
+        ok = (fsync(fileno(f)) == 0) && ok;
+        ok = (fclose(f) == 0) && ok;
+
+        if (!ok || rename(tmp, path))
+            remove(tmp);
+    }
+
+    mpoly_clear(Q, ctx);
+    fmpq_clear(c);
+    mat_clear(N, ctx);
+    fmpz_poly_clear(den);
+    free(key);
+    free(path);
+    free(tmp);
+}
+
@@ -0,0 +1,154 @@
+/******************************************************************************
+
+    Copyright (C) 2013 Sebastian Pancratz
+ 
+******************************************************************************/
+
+#include "gmconnection.h"
+
+/*
+    Sets (g, s, t) such that g = s a + t b = gcd(a, b) with g > 0, 
+    assuming that a and b are not both zero.
+ */
+static void _xgcd(long *g, long *s, long *t, long a, long b)
+{
+    long r0 = a, r1 = b, s0 = 1, s1 = 0, t0 = 0, t1 = 1, q, x;
+
+    while (r1 != 0)
+    {
+        q = r0 / r1;
+        x = r0 - q * r1, r0 = r1, r1 = x;
+        x = s0 - q * s1, s0 = s1, s1 = x;
+        x = t0 - q * t1, t0 = t1, t1 = x;
+    }
+    if (r0 < 0)
+        r0 = -r0, s0 = -s0, t0 = -t0;
+
+    *g = r0, *s = s0, *t = t0;
+}
+
+static long _mod(long a, long d)
+{
+    a = a % d;
+    return (a < 0) ? a + d : a;
+}
+
+/*
+    Given the upper triangular basis H of a lattice in $\mathbf{Z}^m$ 
+    containing $d \mathbf{Z}^m$, with positive diagonal entries, adds 
+    the vector g to the lattice.  Destroys g.
+ */
+static void _lattice_add(long *H, long *g, long m, long d)
+{
+    long i, j, c, s, t, x, y;
+
+    for (i = 0; i < m; i++)
+    {
+        long *h = H + i * m;
+
+        if (g[i] == 0)
+            continue;
+
+        _xgcd(&c, &s, &t, h[i], g[i]);
+        x = h[i] / c;
+        y = g[i] / c;
+
+        for (j = i; j < m; j++)
+        {
+            const long hj = h[j], gj = g[j];
+
+            h[j] = _mod(s * hj + t * gj, d);
+            g[j] = _mod(x * gj - y * hj, d);
+        }
+        h[i] = c;
+        g[i] = 0;
+    }
+}
+
+/*
+    Reduces the vector v to the unique representative of its class 
+    modulo the lattice with upper triangular basis H.
+ */
+static void _lattice_reduce(long *v, const long *H, long m)
+{
+    long i, j, q;
+
+    for (i = 0; i < m; i++)
+    {
+        const long *h = H + i * m;
+
+        q = v[i] / h[i];
+        if (v[i] - q * h[i] < 0)
+            q--;
+        for (j = i; j < m; j++)
+            v[j] -= q * h[j];
+    }
+}
+
+long gmc_character_blocks(long *blk, const mon_t *B, long lenB, 
+                          const mpoly_t P, const ctx_t ctx)
+{
+    const long m = P->n;
+    const long d = mpoly_degree(P, -1, ctx);
+
+    long *H, *g, *R;
+    long i, j, nb;
+    mpoly_iter_t iter;
+    mpoly_term mt;
+
+    H = calloc(m * m, sizeof(long));
+    g = malloc(m * sizeof(long));
+    R = malloc(FLINT_MAX(lenB, 1) * m * sizeof(long));
+
+    /*
+        The characters of the diagonal group $\mu_d^{m}$ form the group 
+        $(\mathbf{Z}/d)^m$, and those that are trivial on the stabiliser 
+        of all monomials of $P$ form the subgroup generated by their 
+        exponent vectors.  Build the lattice of these in $\mathbf{Z}^m$.
+     */
+    for (i = 0; i < m; i++)
+        H[i * m + i] = d;
+
+    mpoly_iter_init(iter, P);
+    while ((mt = mpoly_iter_next(iter)))
+    {
+        for (j = 0; j < m; j++)
+            g[j] = mon_get_exp(mt->key, j) % d;
+        _lattice_add(H, g, m, d);
+    }
+    mpoly_iter_clear(iter);
+
+    /*
+        The form $x^a \Omega / P^k$ is an eigenvector with character 
+        $a + (1, \dotsc, 1)$.  Label the basis monomials by the classes 
+        of their characters, in order of first appearance.
+     */
+    for (nb = 0, i = 0; i < lenB; i++)
+    {
+        for (j = 0; j < m; j++)
+            g[j] = mon_get_exp(B[i], j) + 1;
+        _lattice_reduce(g, H, m);
+
+        for (blk[i] = 0; blk[i] < nb; blk[i]++)
+        {
+            for (j = 0; j < m; j++)
+                if (R[blk[i] * m + j] != g[j])
+                    break;
+            if (j == m)
+                break;
+        }
+        if (blk[i] == nb)
+        {
+            for (j = 0; j < m; j++)
+                R[nb * m + j] = g[j];
+            nb++;
+        }
+    }
+
+    free(H);
+    free(g);
+    free(R);
+
+    return nb;
+}
+
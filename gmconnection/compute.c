@@ -3,68 +3,498 @@
     Copyright (C) 2013 Sebastian Pancratz
  
 ******************************************************************************/
-/******************************************************************************
 
-    Copyright (C) 2013 Sebastian Pancratz
- 
-******************************************************************************/
+#include <pthread.h>
+#include <time.h>
+
+#include "flint_ex.h"
 
 #include "gmconnection.h"
 
 /*
-    Sets the polynomial \code{rop} to the derivative of \code{op} 
-    with respect to the indeterminate $t$ of the base field.
+    Arguments for the threads constructing and factoring the auxiliary 
+    matrices.  The levels k are claimed from the shared counter next 
+    in decreasing order, starting with the largest matrices;  each 
+    thread only writes the entries of the arrays at the levels it has 
+    claimed.
+
+    If build is non-zero, the symbolic data in S is set up first, from 
+    the partial derivatives Dsrc of P over the context of longs, whose 
+    coefficients are the sources of the terms.  In any case, the values 
+    of the auxiliary matrices and of the multiplication operators are 
+    then filled in from the array vals of the values of these terms, 
+    and the auxiliary matrices are factored.
  */
-static void mpoly_tderivative(mpoly_t rop, const mpoly_t op, const ctx_t ctx)
+typedef struct
 {
-    mpoly_t temp;
-    
-    mpoly_iter_t iter;
-    mpoly_term t;
-    
-    if (mpoly_is_zero(op, ctx))
+    __gmc_symbolic_struct *S;
+    mpoly_t *Dsrc;
+    const char *vals;
+    int build;
+    long *next;
+    int *fail;
+    pthread_mutex_t *mutex;
+    const __ctx_struct *ctx;
+} _gmc_aux_arg_struct;
+
+static void * _gmc_aux_worker(void *arg_ptr)
+{
+    const _gmc_aux_arg_struct *arg = arg_ptr;
+    __gmc_symbolic_struct *S = arg->S;
+    const __ctx_struct *ctx = arg->ctx;
+    long k, q, len;
+    int fail;
+
+    while (1)
     {
-        mpoly_zero(rop, ctx);
-        rop->n = op->n;
-        return;
+        pthread_mutex_lock(arg->mutex);
+        k = (*arg->next)--;
+        pthread_mutex_unlock(arg->mutex);
+
+        if (k < S->k0)
+            break;
+
+        if (arg->build)
+        {
+            ctx_t ctxl;
+            mat_csr_t A;
+
+            ctx_init_long(ctxl);
+
+            S->aux_p[k] = malloc((S->n + 2) * sizeof(long));
+
+            _gmc_init_auxmatrix(A, S->aux_rows + k, S->aux_cols + k, 
+                                S->aux_p[k], arg->Dsrc, S->d, k, ctxl);
+
+            /* Take over the sparsity pattern, and the values as sources */
+            S->aux[k]->m     = A->m;
+            S->aux[k]->n     = A->n;
+            S->aux[k]->alloc = A->alloc;
+            S->aux[k]->j     = A->j;
+            S->aux[k]->p     = A->p;
+            S->aux[k]->lenr  = A->lenr;
+            S->aux[k]->x     = (A->alloc > 0) ? _vec_init(A->alloc, ctx) : NULL;
+            S->auxsrc[k]     = (long *) A->x;
+
+            gmc_level_set_ops(S->L[k], S->L[k - 1], arg->Dsrc, 
+                              S->aux_cols[k], S->aux_p[k], ctxl);
+
+            len = (S->L[k]->ncols > 0) ? S->L[k]->mulp[S->L[k]->ncols] : 0;
+            S->mulsrc[k]   = (long *) S->L[k]->mulx;
+            S->L[k]->mulx  = (len > 0) ? _vec_init(len, ctx) : NULL;
+
+            ctx_clear(ctxl);
+        }
+
+        /* Fill in the values */
+        for (q = 0; q < S->aux[k]->alloc; q++)
+            if (S->auxsrc[k][q] > 0)
+                ctx->set(ctx, S->aux[k]->x + q * ctx->size, 
+                              arg->vals + (S->auxsrc[k][q] - 1) * ctx->size);
+
+        len = (S->L[k]->ncols > 0) ? S->L[k]->mulp[S->L[k]->ncols] : 0;
+        for (q = 0; q < len; q++)
+            ctx->set(ctx, S->L[k]->mulx + q * ctx->size, 
+                          arg->vals + (S->mulsrc[k][q] - 1) * ctx->size);
+
+        if (arg->build)
+            fail = (S->ff ? mat_csr_solve_init_ff : mat_csr_solve_init)
+                       (S->aux_s[k], S->aux[k], ctx);
+        else
+            fail = mat_csr_solve_refactor(S->aux_s[k], S->aux[k], ctx);
+
+        if (fail)
+        {
+            pthread_mutex_lock(arg->mutex);
+            *(arg->fail) = 1;
+            pthread_mutex_unlock(arg->mutex);
+        }
     }
-    
-    mpoly_init(temp, op->n, ctx);
-    
-    mpoly_iter_init(iter, op);
-    while ((t = mpoly_iter_next(iter)))
+
+    return NULL;
+}
+
+/*
+    Arguments for the threads reducing the columns of the Gauss--Manin 
+    connection.  All data is shared and read-only except for the 
+    counter next, protected by the mutex, and the matrix M, of which 
+    each thread only writes the columns it has claimed.
+
+    The polynomial dP/dt is given by its lenT terms with monomials 
+    in T and coefficients in Tx.
+
+    At the levels k for which slot[k] is not NULL, the reductions of 
+    the monomials of rank r are memoised;  the reduction of the 
+    monomial of rank r is stored as the vector of length lenB at 
+    position slot[k][r] in the array img, and the monomials to be 
+    reduced in this way are listed in the arrays imgk and imgr, 
+    sorted by level.
+
+    Each thread claims up to batch consecutive images or columns at 
+    the same level at a time, and reduces them together.
+ */
+typedef struct
+{
+    __mat_struct *M;
+    const mon_t *B;
+    const long *iB;
+    long l, u;
+    const mon_t *T;
+    const char *Tx;
+    long lenT;
+    mat_csr_solve_t *aux_s;
+    gmc_level_t *L;
+    long **slot;
+    const long *imgk;
+    const long *imgr;
+    long nimg;
+    char *img;
+    long batch;
+    long *next;
+    pthread_mutex_t *mutex;
+    const __ctx_struct *ctx;
+} _gmc_compute_arg_struct;
+
+static void * _gmc_image_worker(void *arg_ptr)
+{
+    const _gmc_compute_arg_struct *arg = arg_ptr;
+    const __ctx_struct *ctx = arg->ctx;
+    const long l = arg->l;
+    const long u = arg->u;
+    const long lenB = arg->iB[u + 1];
+    const long batch = arg->batch;
+
+    const long lenW = _gmc_reduce_dense_mat_worklen(arg->L, u + 1, batch);
+
+    long c, i, j, j2, k, r, q;
+    char *Q, **R, *W;
+
+    Q = _vec_init(arg->L[u + 1]->len * batch, ctx);
+    R = malloc((u + 1) * sizeof(char *));
+    W = _vec_init(lenW, ctx);
+    for (i = l; i <= u; i++)
+        R[i] = (arg->L[i]->lenB > 0) ? 
+               _vec_init(arg->L[i]->lenB * batch, ctx) : NULL;
+
+    while (1)
     {
-        char *c;
+        pthread_mutex_lock(arg->mutex);
+        j = *arg->next;
+        for (j2 = j + 1; j2 < arg->nimg && j2 - j < batch 
+                         && arg->imgk[j2] == arg->imgk[j]; j2++) ;
+        *arg->next = j2;
+        pthread_mutex_unlock(arg->mutex);
+
+        if (j >= arg->nimg)
+            break;
 
-        c = malloc(ctx->size);
-        ctx->init(ctx, c);
-        ctx->derivative(ctx, c, t->val);
+        k = arg->imgk[j];
+        r = j2 - j;
 
-        if (ctx->is_zero(ctx, c))
+        _vec_zero(Q, arg->L[k]->len * r, ctx);
+        for (c = 0; c < r; c++)
+            ctx->one(ctx, Q + (arg->imgr[j + c] * r + c) * ctx->size);
+
+        _gmc_reduce_dense_mat(R, Q, r, k, arg->L, arg->aux_s, l, u, W, ctx);
+
+        for (i = l; i <= u; i++)
+            for (q = 0; q < arg->L[i]->lenB; q++)
+                for (c = 0; c < r; c++)
+                    ctx->swap(ctx, arg->img + ((j + c) * lenB + arg->iB[i] + q) 
+                                              * ctx->size, 
+                                   R[i] + (q * r + c) * ctx->size);
+    }
+
+    _vec_clear(Q, arg->L[u + 1]->len * batch, ctx);
+    for (i = l; i <= u; i++)
+        if (arg->L[i]->lenB > 0)
+            _vec_clear(R[i], arg->L[i]->lenB * batch, ctx);
+    free(R);
+    _vec_clear(W, lenW, ctx);
+
+    return NULL;
+}
+
+static void * _gmc_compute_worker(void *arg_ptr)
+{
+    const _gmc_compute_arg_struct *arg = arg_ptr;
+    const __ctx_struct *ctx = arg->ctx;
+    const long l = arg->l;
+    const long u = arg->u;
+    const long lenB = arg->iB[u + 1];
+    const long batch = arg->batch;
+
+    const long lenW = _gmc_reduce_dense_mat_worklen(arg->L, u + 1, batch);
+
+    long c, i, j, j2, q, r, colk, rowk;
+    char *Q, **R, *W, *t, *s;
+
+    Q = _vec_init(arg->L[u + 1]->len * batch, ctx);
+    R = malloc((u + 1) * sizeof(char *));
+    W = _vec_init(lenW, ctx);
+    for (i = l; i <= u; i++)
+        R[i] = (arg->L[i]->lenB > 0) ? 
+               _vec_init(arg->L[i]->lenB * batch, ctx) : NULL;
+    t = malloc(ctx->size);
+    ctx->init(ctx, t);
+    s = malloc(ctx->size);
+    ctx->init(ctx, s);
+
+    while (1)
+    {
+        pthread_mutex_lock(arg->mutex);
+        j = *arg->next;
+        if (j < lenB)
         {
-            ctx->clear(ctx, c);
-            free(c);
+            colk = l;
+            while (arg->iB[colk + 1] <= j)
+                colk++;
+            j2 = FLINT_MIN(j + batch, arg->iB[colk + 1]);
         }
         else
         {
-            mon_t m2;
-            void *c2;
+            colk = l;
+            j2   = j;
+        }
+        *arg->next = j2;
+        pthread_mutex_unlock(arg->mutex);
+
+        if (j >= lenB)
+            break;
+
+        r = j2 - j;
+
+        /* Combine the memoised reductions of the terms of -colk B[j] dPdt */
+        if (arg->slot[colk + 1])
+        {
+            for (c = 0; c < r; c++)
+            {
+                for (i = 0; i < lenB; i++)
+                    ctx->zero(ctx, mat_entry(arg->M, i, j + c, ctx));
+
+                for (q = 0; q < arg->lenT; q++)
+                {
+                    const char *v;
+                    mon_t m;
+                    long k;
+
+                    mon_mul(m, arg->T[q], arg->B[j + c]);
+                    k = gmc_level_rank(arg->L[colk + 1], m);
+                    v = arg->img + arg->slot[colk + 1][k] * lenB * ctx->size;
+
+                    ctx->set_si(ctx, t, -colk);
+                    ctx->mul(ctx, t, t, arg->Tx + q * ctx->size);
+
+                    for (i = 0; i < lenB; i++)
+                    {
+                        char *e = mat_entry(arg->M, i, j + c, ctx);
+
+                        if (!ctx->is_zero(ctx, v + i * ctx->size))
+                        {
+                            ctx->mul(ctx, s, t, v + i * ctx->size);
+                            ctx->add(ctx, e, e, s);
+                        }
+                    }
+                }
+            }
+            continue;
+        }
+
+        /* Set the columns of Q to -colk B[j] dPdt, and then reduce */
+        _vec_zero(Q, arg->L[colk + 1]->len * r, ctx);
+        ctx->set_si(ctx, t, -colk);
+        for (c = 0; c < r; c++)
+            for (i = 0; i < arg->lenT; i++)
+            {
+                mon_t m;
+                long k;
+
+                mon_mul(m, arg->T[i], arg->B[j + c]);
+                k = gmc_level_rank(arg->L[colk + 1], m);
+                ctx->mul(ctx, Q + (k * r + c) * ctx->size, 
+                              t, arg->Tx + i * ctx->size);
+            }
+
+        _gmc_reduce_dense_mat(R, Q, r, colk + 1, arg->L, arg->aux_s, 
+                              l, u, W, ctx);
 
-            /* Note that no entry with this key is present in temp yet */
-            RBTREE_INSERT(mpoly, &m2, &c2, temp->dict, t->key, c, &mon_cmp);
+        /* Extract the column vectors */
+
+        for (rowk = l; rowk <= FLINT_MIN(u, colk + 1); rowk++)
+        {
+            for (i = arg->iB[rowk]; i < arg->iB[rowk + 1]; i++)
+                for (c = 0; c < r; c++)
+                {
+                    ctx->swap(ctx, mat_entry(arg->M, i, j + c, ctx), 
+                        R[rowk] + ((i - arg->iB[rowk]) * r + c) * ctx->size);
+                }
         }
     }
-    mpoly_iter_clear(iter);
-    
-    mpoly_swap(rop, temp, ctx);
-    mpoly_clear(temp, ctx);
+
+    _vec_clear(Q, arg->L[u + 1]->len * batch, ctx);
+    for (i = l; i <= u; i++)
+        if (arg->L[i]->lenB > 0)
+            _vec_clear(R[i], arg->L[i]->lenB * batch, ctx);
+    free(R);
+    _vec_clear(W, lenW, ctx);
+    ctx->clear(ctx, t);
+    free(t);
+    ctx->clear(ctx, s);
+    free(s);
+
+    return NULL;
 }
 
-void gmc_compute(mat_t M, mon_t **rows, mon_t **cols, 
-                 const mpoly_t P, const ctx_t ctx)
+/*
+    Returns whether the symbolic data S has been set up for the partial 
+    derivatives dP of a polynomial in n + 1 variables of degree d, that 
+    is, whether their supports agree, and if so sets the array vals to 
+    the values of their terms.
+ */
+static int _gmc_symbolic_match(char *vals, const gmc_symbolic_t S, 
+                               mpoly_t *dP, long n, long d, int ff, 
+                               const ctx_t ctx)
+{
+    long i, var;
+
+    if (!S->built || S->n != n || S->d != d || S->ff != ff)
+        return 0;
+
+    for (var = 0; var <= n; var++)
+    {
+        mpoly_iter_t iter;
+        mpoly_term mt;
+
+        i = S->iD[var];
+        mpoly_iter_init(iter, dP[var]);
+        while ((mt = mpoly_iter_next(iter)))
+        {
+            if (i == S->iD[var + 1] || mt->key != S->D[i])
+                break;
+            ctx->set(ctx, vals + i * ctx->size, mt->val);
+            i++;
+        }
+        mpoly_iter_clear(iter);
+
+        if (mt || i != S->iD[var + 1])
+            return 0;
+    }
+
+    return 1;
+}
+
+/*
+    Sets up the index sets and levels of the symbolic data S for the 
+    partial derivatives dP of a polynomial in n + 1 variables of degree 
+    d, and the array vals of the values of their terms.  Sets Dsrc to 
+    the partial derivatives over the context of longs ctxl, whose 
+    coefficients are one more than the index of the term in vals.
+ */
+static void _gmc_symbolic_setup(gmc_symbolic_t S, char **vals, mpoly_t *Dsrc, 
+                                mpoly_t *dP, long n, long d, int ff, 
+                                const ctx_t ctxl, const ctx_t ctx)
+{
+    long i, k, var;
+
+    S->n  = n;
+    S->d  = d;
+    S->ff = ff;
+
+    /* Terms of the partial derivatives */
+    S->iD = malloc((n + 2) * sizeof(long));
+    S->iD[0] = 0;
+    for (var = 0; var <= n; var++)
+    {
+        mpoly_iter_t iter;
+
+        S->iD[var + 1] = S->iD[var];
+        mpoly_iter_init(iter, dP[var]);
+        while (mpoly_iter_next(iter))
+            S->iD[var + 1]++;
+        mpoly_iter_clear(iter);
+    }
+    S->lenD = S->iD[n + 1];
+    S->D    = malloc(S->lenD * sizeof(mon_t));
+    *vals   = _vec_init(FLINT_MAX(S->lenD, 1), ctx);
+
+    i = 0;
+    for (var = 0; var <= n; var++)
+    {
+        mpoly_iter_t iter;
+        mpoly_term mt;
+
+        mpoly_iter_init(iter, dP[var]);
+        while ((mt = mpoly_iter_next(iter)))
+        {
+            long src = i + 1;
+
+            S->D[i] = mt->key;
+            ctx->set(ctx, *vals + i * ctx->size, mt->val);
+            mpoly_set_coeff(Dsrc[var], mt->key, &src, ctxl);
+            i++;
+        }
+        mpoly_iter_clear(iter);
+    }
+
+    /* Index sets and levels */
+    gmc_basis_sets(&(S->B), &(S->iB), &(S->lenB), &(S->l), &(S->u), n, d);
+
+    S->k0 = (n + (d - 1)) / d + 1;  /* k0 = ceil(n / d) + 1 */
+
+    S->L = malloc((S->u + 2) * sizeof(gmc_level_t));
+    for (k = 0; k <= S->u + 1; k++)
+        gmc_level_init(S->L[k], n, d, k);
+
+    /*
+        Arrays for the auxiliary matrices
+
+        Note that a priori we might need them for k = 1, ..., n, n+1. 
+        The rows and columns sets are only non-empty if (k-1)*d >= n.
+
+        To ease indexing, we include the empty set in the case k = 0.
+     */
+    S->aux      = malloc((n + 2) * sizeof(mat_csr_t));
+    S->auxsrc   = malloc((n + 2) * sizeof(long *));
+    S->aux_rows = malloc((n + 2) * sizeof(mon_t *));
+    S->aux_cols = malloc((n + 2) * sizeof(mon_t *));
+    S->aux_p    = malloc((n + 2) * sizeof(long *));
+    S->aux_s    = malloc((n + 2) * sizeof(mat_csr_solve_t));
+    S->mulsrc   = calloc(S->u + 2, sizeof(long *));
+
+    S->built = 1;
+}
+
+/* Returns the wall clock time in seconds */
+static double _gmc_clock(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1.0e-9 * ts.tv_nsec;
+}
+
+/*
+    If S has an array of phase timers, adds the wall clock time elapsed 
+    since *c to the given phase and resets *c to the current time.
+ */
+static void _gmc_phase(gmc_symbolic_t S, long phase, double *c)
+{
+    if (S->time)
+    {
+        const double now = _gmc_clock();
+
+        S->time[phase] += now - *c;
+        *c = now;
+    }
+}
+
+int _gmc_compute_cached(mat_t M, mon_t **rows, mon_t **cols, 
+                        const mpoly_t P, const mpoly_t dPdt, int ff, 
+                        gmc_symbolic_t S, const ctx_t ctx)
 {
-    long i, j, k, colk, rowk;
-    mpoly_t *dP, dPdt;
+    long i, k;
+    mpoly_t *dP;
+    int build, same, fail = 0;
 
     mon_t *B;
     long *iB, l, u, lenB;
@@ -72,129 +502,342 @@ void gmc_compute(mat_t M, mon_t **rows, mon_t **cols,
     const long n = P->n - 1;
     const long d = mpoly_degree(P, -1, ctx);
     
-    /*
-        Arrays for the auxiliary matrices;  the arrays are of length u + 1 
-        but they are NULL when k < l
-     */
-    mat_csr_t *aux;
-    mon_t **aux_rows, **aux_cols;
-    long **aux_p;
+    /* Solve structures for the auxiliary matrices, for k0 <= k <= u + 1 */
     mat_csr_solve_t *aux_s;
-    
-    /*
-        Compute all partial derivatives of P, and the derivative of P with 
-        respect to t, the variable of the coefficient field
-     */
+
+    /* Dense representations for the levels k = 0, ..., u + 1 */
+    gmc_level_t *L;
+
+    /* Values of the terms of the partial derivatives */
+    char *vals;
+
+    /* Terms of dP/dt */
+    mon_t *T;
+    char *Tx;
+    long lenT;
+
+    /* Start of the current phase, if timed */
+    double c = S->time ? _gmc_clock() : 0.0;
+
+    /* Compute all partial derivatives of P */
     dP = malloc((n + 1) * sizeof(mpoly_t));
     for (i = 0; i <= n; i++)
         mpoly_init(dP[i], n + 1, ctx);
     gmc_derivatives(dP, P, ctx);
-    mpoly_init(dPdt, n + 1, ctx);
-    mpoly_tderivative(dPdt, P, ctx);
-    
-    /* Construct the index set B */
-    gmc_basis_sets(&B, &iB, &lenB, &l, &u, n, d);
-    
+
     /*
-        Construct the auxiliary matrices
+        Unless S has been set up for the same supports, set up its index 
+        sets and the arrays for the auxiliary matrices anew
+     */
+    {
+        ctx_t ctxl;
+        mpoly_t *Dsrc = NULL;
 
-        Note that a priori we might need them for k = 1, ..., n, n+1. 
-        The rows and columns sets are only non-empty if (k-1)*d >= n.
+        ctx_init_long(ctxl);
 
-        To ease indexing, we include the empty set in the case k = 0.
-     */
-    aux      = malloc((n + 2) * sizeof(mat_csr_t));
-    aux_rows = malloc((n + 2) * sizeof(mon_t *));
-    aux_cols = malloc((n + 2) * sizeof(mon_t *));
-    aux_p    = malloc((n + 2) * sizeof(long *));
-    aux_s    = malloc((n + 2) * sizeof(mat_csr_solve_t));
+        vals  = _vec_init(S->built ? FLINT_MAX(S->lenD, 1) : 1, ctx);
+        build = !_gmc_symbolic_match(vals, S, dP, n, d, ff, ctx);
+
+        if (build)
+        {
+            _vec_clear(vals, S->built ? FLINT_MAX(S->lenD, 1) : 1, ctx);
+            gmc_symbolic_clear(S, ctx);
+
+            Dsrc = malloc((n + 1) * sizeof(mpoly_t));
+            for (i = 0; i <= n; i++)
+                mpoly_init(Dsrc[i], n + 1, ctxl);
+
+            _gmc_symbolic_setup(S, &vals, Dsrc, dP, n, d, ff, ctxl, ctx);
+        }
+
+        _gmc_phase(S, GMC_PHASE_SETUP, &c);
+
+        /*
+            Construct and factor the auxiliary matrices, unless they have 
+            already been factored successfully for the same values
+         */
+        same = !build && S->vals && _vec_equal(vals, S->vals, S->lenD, ctx);
+
+        if (!same)
+        {
+            _gmc_aux_arg_struct *args;
+            pthread_mutex_t mutex;
+            long next, t, nt;
+
+            nt = FLINT_MAX(1, FLINT_MIN(flint_parallel_num_threads(), 
+                                        S->u + 2 - S->k0));
+
+            args = malloc(nt * sizeof(_gmc_aux_arg_struct));
+
+            pthread_mutex_init(&mutex, NULL);
+            next = S->u + 1;
+
+            for (t = 0; t < nt; t++)
+            {
+                args[t].S     = S;
+                args[t].Dsrc  = Dsrc;
+                args[t].vals  = vals;
+                args[t].build = build;
+                args[t].next  = &next;
+                args[t].fail  = &fail;
+                args[t].mutex = &mutex;
+                args[t].ctx   = ctx;
+            }
+
+            flint_parallel_run(_gmc_aux_worker, args, 
+                               sizeof(_gmc_aux_arg_struct), nt);
+
+            pthread_mutex_destroy(&mutex);
+            free(args);
+
+            if (!fail)
+            {
+                if (!S->vals)
+                    S->vals = _vec_init(FLINT_MAX(S->lenD, 1), ctx);
+                _vec_set(S->vals, vals, S->lenD, ctx);
+            }
+            else if (S->vals)
+            {
+                _vec_clear(S->vals, FLINT_MAX(S->lenD, 1), ctx);
+                S->vals = NULL;
+            }
+        }
+
+        _gmc_phase(S, GMC_PHASE_AUX, &c);
 
-    for (k = (n + (d - 1)) / d + 1; k <= u + 1; k++)
+        _vec_clear(vals, FLINT_MAX(S->lenD, 1), ctx);
+
+        if (build)
+        {
+            for (i = 0; i <= n; i++)
+                mpoly_clear(Dsrc[i], ctxl);
+            free(Dsrc);
+        }
+
+        ctx_clear(ctxl);
+    }
+
+    B     = S->B;
+    iB    = S->iB;
+    lenB  = S->lenB;
+    l     = S->l;
+    u     = S->u;
+    L     = S->L;
+    aux_s = S->aux_s;
+
+    /* Unpack the terms of dP/dt */
     {
-        aux_p[k] = malloc((n + 2) * sizeof(long));
+        mpoly_iter_t iter;
+        mpoly_term mt;
+
+        lenT = 0;
+        mpoly_iter_init(iter, dPdt);
+        while ((mt = mpoly_iter_next(iter)))
+            lenT++;
+        mpoly_iter_clear(iter);
 
-        gmc_init_auxmatrix(aux[k], aux_rows + k, aux_cols + k, aux_p[k], 
-                           P, k, ctx);
+        T  = malloc(lenT * sizeof(mon_t));
+        Tx = (lenT > 0) ? _vec_init(lenT, ctx) : NULL;
 
-        mat_csr_solve_init(aux_s[k], aux[k], ctx);
+        lenT = 0;
+        mpoly_iter_init(iter, dPdt);
+        while ((mt = mpoly_iter_next(iter)))
+        {
+            T[lenT] = mt->key;
+            ctx->set(ctx, Tx + lenT * ctx->size, mt->val);
+            lenT++;
+        }
+        mpoly_iter_clear(iter);
     }
     
-    /* Construct the Gauss--Manin connection matrix */
-
-    for (colk = l; colk <= u; colk++)
+    /* The remaining steps require all auxiliary matrices to be invertible */
+    if (!fail)
     {
-        for (j = iB[colk]; j < iB[colk + 1]; j++)
+        /*
+            Set up the memoised reductions.  The columns in the block for 
+            colk only require the reductions of the monomials T[i] B[j] at 
+            level k = colk + 1.  When there are fewer distinct ones than 
+            columns, we reduce each such monomial once and then express 
+            the columns as linear combinations of the images.
+
+            The images only depend on the auxiliary matrices and on the 
+            monomials of dP/dt, so they are kept in S and only recomputed 
+            when either of these has changed since the last call.
+         */
+        int plan = S->slot && S->lenT == lenT;
+
+        for (i = 0; plan && i < lenT; i++)
+            plan = (S->T[i] == T[i]);
+
+        if (!plan)
         {
-            mpoly_t Q, *R;
-
-            mpoly_init(Q, n + 1, ctx);
-            R = malloc((n + 2) * sizeof(mpoly_t));
-            for (i = 0; i <= n + 1; i++)
-                mpoly_init(R[i], n + 1, ctx);
-
-            /* Set Q to -colk B[j] dPdt, and then reduce */
-            mpoly_mul_mon(Q, dPdt, B[j], ctx);
-            mpoly_scalar_mul_si(Q, Q, -colk, ctx);
-            
-            gmc_reduce(R, Q, colk + 1, d, dP, 
-                       aux_s, aux_rows, aux_cols, aux_p, l, u, ctx);
-
-            /* Extract the column vector */
-            
-            /* Iterate over all rows.. */
-            
-            for (rowk = l; rowk <= FLINT_MIN(u, colk + 1); rowk++)
+            _gmc_symbolic_clear_memo(S, ctx);
+
+            S->lenT = lenT;
+            S->T    = malloc(FLINT_MAX(lenT, 1) * sizeof(mon_t));
+            for (i = 0; i < lenT; i++)
+                S->T[i] = T[i];
+
+            S->slot = malloc((u + 2) * sizeof(long *));
+            S->nimg = 0;
+            for (k = 0; k <= l; k++)
+                S->slot[k] = NULL;
+            for (k = l + 1; k <= u + 1; k++)
             {
-                for (i = iB[rowk]; i < iB[rowk + 1]; i++)
+                long c = 0, j, t;
+
+                S->slot[k] = malloc(L[k]->len * sizeof(long));
+                for (i = 0; i < L[k]->len; i++)
+                    S->slot[k][i] = -1;
+
+                for (j = iB[k - 1]; j < iB[k]; j++)
+                    for (t = 0; t < lenT; t++)
+                    {
+                        mon_t m;
+                        long r;
+
+                        mon_mul(m, T[t], B[j]);
+                        r = gmc_level_rank(L[k], m);
+                        if (S->slot[k][r] < 0)
+                            S->slot[k][r] = S->nimg + (c++);
+                    }
+
+                if (c < iB[k] - iB[k - 1])
                 {
-                    mpoly_get_coeff(mat_entry(M, i, j, ctx), 
-                                    R[rowk], B[i], ctx);
+                    S->nimg += c;
+                }
+                else
+                {
+                    free(S->slot[k]);
+                    S->slot[k] = NULL;
                 }
             }
 
-            mpoly_clear(Q, ctx);
-            for (i = 0; i <= n + 1; i++)
-                mpoly_clear(R[i], ctx);
-            free(R);
+            S->imgk = malloc(FLINT_MAX(S->nimg, 1) * sizeof(long));
+            S->imgr = malloc(FLINT_MAX(S->nimg, 1) * sizeof(long));
+            for (k = l + 1; k <= u + 1; k++)
+                if (S->slot[k])
+                    for (i = 0; i < L[k]->len; i++)
+                        if (S->slot[k][i] >= 0)
+                        {
+                            S->imgk[S->slot[k][i]] = k;
+                            S->imgr[S->slot[k][i]] = i;
+                        }
+            S->img = (S->nimg > 0) ? _vec_init(S->nimg * lenB, ctx) : NULL;
         }
-    }
 
-    /* Copy row and column index sets */
+        /* Construct the Gauss--Manin connection matrix */
+        {
+            _gmc_compute_arg_struct *args;
+            pthread_mutex_t mutex;
+            long batch, next, t, nt;
+
+            nt = FLINT_MAX(1, FLINT_MIN(flint_parallel_num_threads(), lenB));
 
-    *rows = malloc(lenB * sizeof(mon_t));
-    *cols = malloc(lenB * sizeof(mon_t));
+            batch = FLINT_MAX(1, FLINT_MIN(GMC_REDUCE_BATCH, lenB / nt));
 
-    for (i = 0; i < lenB; i++)
-    {
-        (*rows)[i] = B[i];
-        (*cols)[i] = B[i];
-    }
+            args = malloc(nt * sizeof(_gmc_compute_arg_struct));
 
-    /* Clean up */
+            pthread_mutex_init(&mutex, NULL);
 
-    k = (n + (d - 1)) / d + 1;  /* k = ceil(n / d) + 1 */
+            for (t = 0; t < nt; t++)
+            {
+                args[t].M        = M;
+                args[t].B        = B;
+                args[t].iB       = iB;
+                args[t].l        = l;
+                args[t].u        = u;
+                args[t].T        = T;
+                args[t].Tx       = Tx;
+                args[t].lenT     = lenT;
+                args[t].aux_s    = aux_s;
+                args[t].L        = L;
+                args[t].slot     = S->slot;
+                args[t].imgk     = S->imgk;
+                args[t].imgr     = S->imgr;
+                args[t].nimg     = S->nimg;
+                args[t].img      = S->img;
+                args[t].batch    = batch;
+                args[t].next     = &next;
+                args[t].mutex    = &mutex;
+                args[t].ctx      = ctx;
+            }
 
-    for ( ; k <= u + 1; k++)
-    {
-        free(aux_rows[k]);
-        free(aux_cols[k]);
-        free(aux_p[k]);
-        mat_csr_clear(aux[k], ctx);
-        mat_csr_solve_clear(aux_s[k], ctx);
+            /* First the memoised reductions, then the columns */
+            if (!plan || !same)
+            {
+                next = 0;
+
+                flint_parallel_run(_gmc_image_worker, args, 
+                                   sizeof(_gmc_compute_arg_struct), nt);
+            }
+
+            _gmc_phase(S, GMC_PHASE_IMAGE, &c);
+
+            next = iB[l];
+
+            flint_parallel_run(_gmc_compute_worker, args, 
+                               sizeof(_gmc_compute_arg_struct), nt);
+
+            pthread_mutex_destroy(&mutex);
+            free(args);
+        }
+
+        /* Copy row and column index sets */
+
+        *rows = malloc(lenB * sizeof(mon_t));
+        *cols = malloc(lenB * sizeof(mon_t));
+
+        for (i = 0; i < lenB; i++)
+        {
+            (*rows)[i] = B[i];
+            (*cols)[i] = B[i];
+        }
     }
 
-    free(aux);
-    free(aux_rows);
-    free(aux_cols);
-    free(aux_p);
-    free(aux_s);
+    /* Clean up */
 
-    free(B);
-    free(iB);
+    free(T);
+    if (lenT > 0)
+        _vec_clear(Tx, lenT, ctx);
 
     for (i = 0; i <= n; i++)
         mpoly_clear(dP[i], ctx);
     free(dP);
+
+    _gmc_phase(S, GMC_PHASE_REDUCE, &c);
+
+    return fail;
+}
+
+int _gmc_compute(mat_t M, mon_t **rows, mon_t **cols, 
+                 const mpoly_t P, const mpoly_t dPdt, int ff, const ctx_t ctx)
+{
+    gmc_symbolic_t S;
+    int fail;
+
+    gmc_symbolic_init(S);
+    fail = _gmc_compute_cached(M, rows, cols, P, dPdt, ff, S, ctx);
+    gmc_symbolic_clear(S, ctx);
+
+    return fail;
+}
+
+void gmc_compute(mat_t M, mon_t **rows, mon_t **cols, 
+                 const mpoly_t P, const ctx_t ctx)
+{
+    mpoly_t dPdt;
+
+    /* The derivative of P with respect to t, the variable of the base field */
+    mpoly_init(dPdt, P->n, ctx);
+    mpoly_tderivative(dPdt, P, ctx);
+
+    if (_gmc_compute(M, rows, cols, P, dPdt, 1, ctx))
+    {
+        printf("ERROR (gmc_compute).  Singular auxiliary matrix.\n\n");
+        abort();
+    }
+
     mpoly_clear(dPdt, ctx);
 }
 
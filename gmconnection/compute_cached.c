@@ -0,0 +1,25 @@
+/******************************************************************************
+
+    Copyright (C) 2013 Sebastian Pancratz
+ 
+******************************************************************************/
+
+#include "gmconnection.h"
+
+void gmc_compute_cached(mat_t M, mon_t **rows, mon_t **cols, 
+                        const mpoly_t P, gmc_symbolic_t S, const ctx_t ctx)
+{
+    mpoly_t dPdt;
+
+    mpoly_init(dPdt, P->n, ctx);
+    mpoly_tderivative(dPdt, P, ctx);
+
+    if (_gmc_compute_cached(M, rows, cols, P, dPdt, 1, S, ctx))
+    {
+        printf("ERROR (gmc_compute_cached).  Singular auxiliary matrix.\n\n");
+        abort();
+    }
+
+    mpoly_clear(dPdt, ctx);
+}
+
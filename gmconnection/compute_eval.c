@@ -0,0 +1,369 @@
+/******************************************************************************
+
+    Copyright (C) 2013 Sebastian Pancratz
+
+******************************************************************************/
+
+#include <gmp.h>
+
+#include "flint/fmpq.h"
+#include "flint/fmpq_poly.h"
+
+#include "flint_ex.h"
+#include "gmconnection.h"
+
+/*
+    Sets rop over $\mathbf{Q}$ to the polynomial op over $\mathbf{Q}(t)$
+    with $t$ specialised to $a$.
+
+    Returns $0$ if one of the coefficients has a pole at $a$, or if
+    strict is non-zero and one of the coefficients vanishes at $a$,
+    in which case the point $a$ should not be used.  Returns $1$
+    otherwise.
+ */
+static int _mpoly_specialise(mpoly_t rop, const mpoly_t op, const mpq_t a,
+                             int strict, const ctx_t ctxQ)
+{
+    mpoly_iter_t iter;
+    mpoly_term mt;
+    int ans = 1;
+    mpq_t c;
+
+    mpq_init(c);
+    mpoly_zero(rop, ctxQ);
+
+    mpoly_iter_init(iter, op);
+    while (ans && (mt = mpoly_iter_next(iter)))
+    {
+        if (fmpz_poly_q_evaluate(c, (fmpz_poly_q_struct *) mt->val, a)
+            || (strict && mpq_sgn(c) == 0))
+            ans = 0;
+        else
+            mpoly_set_coeff(rop, mt->key, c, ctxQ);
+    }
+    mpoly_iter_clear(iter);
+
+    mpq_clear(c);
+    return ans;
+}
+
+/*
+    Computes the values y of length b^2 of the entries of the connection
+    matrix at $t = a$, by running the reduction over $\mathbf{Q}$.
+
+    Returns $0$ if $a$ is not a suitable point, that is, if not all
+    coefficients of $P$ are finite and non-zero at $a$ or if one of the
+    auxiliary matrices is singular at $a$.  Since the sparsity pattern
+    of the auxiliary matrices at suitable points agrees with the generic
+    one, and all of them are invertible, the values are exactly those
+    of the connection matrix over $\mathbf{Q}(t)$ at $a$.
+
+    The symbolic data S is shared between the points, so that the
+    sparsity patterns of the auxiliary matrices are only analysed once.
+ */
+static int _gmc_compute_at(fmpq *y, mon_t **rows, mon_t **cols, long b,
+                           const mpoly_t P, const mpoly_t dPdt,
+                           const fmpz_t a, gmc_symbolic_t S,
+                           const ctx_t ctxQ)
+{
+    mpoly_t Pa, dPdta;
+    mat_t Ma;
+    mpq_t x;
+    long i, j;
+    int ans;
+
+    mpq_init(x);
+    fmpz_get_mpz(mpq_numref(x), a);
+
+    mpoly_init(Pa, P->n, ctxQ);
+    mpoly_init(dPdta, P->n, ctxQ);
+
+    ans = _mpoly_specialise(Pa, P, x, 1, ctxQ)
+       && _mpoly_specialise(dPdta, dPdt, x, 0, ctxQ);
+
+    if (ans)
+    {
+        mat_init(Ma, b, b, ctxQ);
+
+        ans = !_gmc_compute_cached(Ma, rows, cols, Pa, dPdta, 0, S, ctxQ);
+
+        if (ans)
+            for (i = 0; i < b; i++)
+                for (j = 0; j < b; j++)
+                    fmpq_set_mpq(y + (i * b + j),
+                                 (__mpq_struct *) mat_entry(Ma, i, j, ctxQ));
+
+        mat_clear(Ma, ctxQ);
+    }
+
+    mpoly_clear(Pa, ctxQ);
+    mpoly_clear(dPdta, ctxQ);
+    mpq_clear(x);
+
+    return ans;
+}
+
+/*
+    Given the values y[0], ..., y[m-1] at the distinct points a[0], ...,
+    a[m-1], attempts to find a rational function N/D with D monic,
+    deg(N) < k and deg(D) <= m - k, where k = ceil(m/2), interpolating
+    these values.
+
+    Computes the interpolating polynomial L in Newton form, and then 
+    reconstructs N/D from L modulo Z, the product of all (t - a[i]).
+
+    Returns $1$ if such a rational function is found, and $0$ otherwise.
+ */
+static int _fmpq_poly_ratinterp(fmpq_poly_t N, fmpq_poly_t D,
+                                const fmpz *a, const fmpq *y, long m)
+{
+    const long k = (m + 1) / 2;
+
+    fmpq *c;
+    fmpq_poly_t L, Z, lin, q;
+    fmpq_t x;
+    fmpz_t z;
+    long i, j;
+    int ans;
+
+    c = _fmpq_vec_init(m);
+    fmpq_poly_init(L);
+    fmpq_poly_init(Z);
+    fmpq_poly_init(lin);
+    fmpq_poly_init(q);
+    fmpq_init(x);
+    fmpz_init(z);
+
+    /* Divided differences */
+    for (i = 0; i < m; i++)
+        fmpq_set(c + i, y + i);
+    for (j = 1; j < m; j++)
+        for (i = m - 1; i >= j; i--)
+        {
+            fmpq_sub(c + i, c + i, c + (i - 1));
+            fmpz_sub(z, a + i, a + (i - j));
+            fmpq_div_fmpz(c + i, c + i, z);
+        }
+
+    /* L and Z */
+    fmpq_poly_zero(L);
+    fmpq_poly_one(Z);
+    for (i = m - 1; i >= 0; i--)
+    {
+        fmpq_poly_zero(lin);
+        fmpq_poly_set_coeff_si(lin, 1, 1);
+        fmpz_neg(z, a + i);
+        fmpq_poly_set_coeff_fmpz(lin, 0, z);
+
+        fmpq_poly_mul(L, L, lin);
+        fmpq_poly_set_fmpq(q, c + i);
+        fmpq_poly_add(L, L, q);
+
+        fmpq_poly_mul(Z, Z, lin);
+    }
+
+    ans = fmpq_poly_ratrecon(N, D, L, Z, k);
+
+    /* The denominator may not vanish at any of the points */
+    for (i = 0; ans && i < m; i++)
+    {
+        fmpq_poly_evaluate_fmpz(x, D, a + i);
+        if (fmpq_is_zero(x))
+            ans = 0;
+    }
+
+    _fmpq_vec_clear(c, m);
+    fmpq_poly_clear(L);
+    fmpq_poly_clear(Z);
+    fmpq_poly_clear(lin);
+    fmpq_poly_clear(q);
+    fmpq_clear(x);
+    fmpz_clear(z);
+
+    return ans;
+}
+
+/*
+    Sets the element rop of $\mathbf{Q}(t)$ to N/D.
+ */
+static void _fmpz_poly_q_set_fmpq_poly_frac(fmpz_poly_q_t rop,
+                                            const fmpq_poly_t N,
+                                            const fmpq_poly_t D)
+{
+    if (fmpq_poly_is_zero(N))
+    {
+        fmpz_poly_q_zero(rop);
+    }
+    else
+    {
+        fmpq_poly_get_numerator(rop->num, N);
+        fmpz_poly_scalar_mul_fmpz(rop->num, rop->num, fmpq_poly_denref(D));
+        fmpq_poly_get_numerator(rop->den, D);
+        fmpz_poly_scalar_mul_fmpz(rop->den, rop->den, fmpq_poly_denref(N));
+        fmpz_poly_q_canonicalise(rop);
+    }
+}
+
+/*
+    Appends the next suitable point from the sequence 0, 1, -1, 2, -2, ... 
+    to the array a of length m, and the values of the connection matrix 
+    at this point to the array y, reallocating both as necessary.
+ */
+static void _gmc_add_point(fmpz **a, fmpq ***y, long *alloc, long *m, 
+                           long *next, mon_t **rows, mon_t **cols, long b, 
+                           const mpoly_t P, const mpoly_t dPdt, 
+                           gmc_symbolic_t S, const ctx_t ctxQ)
+{
+    while (1)
+    {
+        mon_t *r, *c;
+
+        if (*m == *alloc)
+        {
+            *alloc = FLINT_MAX(2 * (*alloc), 16);
+            *a = realloc(*a, *alloc * sizeof(fmpz));
+            *y = realloc(*y, *alloc * sizeof(fmpq *));
+        }
+
+        fmpz_init(*a + *m);
+        fmpz_set_si(*a + *m, (*next % 2) ? (*next + 1) / 2 : - (*next / 2));
+        (*next)++;
+        (*y)[*m] = _fmpq_vec_init(b * b);
+
+        if (_gmc_compute_at((*y)[*m], &r, &c, b, P, dPdt, *a + *m, S, ctxQ))
+        {
+            if (*rows)
+            {
+                free(r);
+                free(c);
+            }
+            else
+            {
+                *rows = r;
+                *cols = c;
+            }
+            (*m)++;
+            return;
+        }
+
+        fmpz_clear(*a + *m);
+        _fmpq_vec_clear((*y)[*m], b * b);
+    }
+}
+
+void gmc_compute_eval(mat_t M, mon_t **rows, mon_t **cols, 
+                      const mpoly_t P, const ctx_t ctx)
+{
+    const long b = M->m;
+
+    ctx_t ctxQ;
+    mpoly_t dPdt;
+    gmc_symbolic_t S;
+
+    fmpz *a;        /* Points */
+    fmpq **y;       /* Values y[i] at the point a[i], of length b^2 */
+    long alloc, m, target, next, e, i;
+
+    fmpq *v;
+    fmpq_poly_struct *N, *D;
+    fmpq_t w, x;
+
+    ctx_init_mpq(ctxQ);
+    mpoly_init(dPdt, P->n, ctx);
+    mpoly_tderivative(dPdt, P, ctx);
+    gmc_symbolic_init(S);
+
+    alloc  = 0;
+    a      = NULL;
+    y      = NULL;
+    m      = 0;
+    target = 8;
+    next   = 0;
+
+    *rows = NULL;
+    *cols = NULL;
+
+    N = malloc(b * b * sizeof(fmpq_poly_struct));
+    D = malloc(b * b * sizeof(fmpq_poly_struct));
+    for (e = 0; e < b * b; e++)
+    {
+        fmpq_poly_init(N + e);
+        fmpq_poly_init(D + e);
+    }
+    fmpq_init(w);
+    fmpq_init(x);
+
+    while (1)
+    {
+        int ok = 1;
+
+        while (m < target)
+            _gmc_add_point(&a, &y, &alloc, &m, &next, rows, cols, b, 
+                           P, dPdt, S, ctxQ);
+
+        /* Reconstruct all entries from the values at the m points */
+        v = _fmpq_vec_init(m);
+        for (e = 0; ok && e < b * b; e++)
+        {
+            for (i = 0; i < m; i++)
+                fmpq_set(v + i, y[i] + e);
+            ok = _fmpq_poly_ratinterp(N + e, D + e, a, v, m);
+        }
+        _fmpq_vec_clear(v, m);
+
+        /* Check the candidates at one further point */
+        if (ok)
+        {
+            _gmc_add_point(&a, &y, &alloc, &m, &next, rows, cols, b, 
+                           P, dPdt, S, ctxQ);
+
+            for (e = 0; ok && e < b * b; e++)
+            {
+                fmpq_poly_evaluate_fmpz(x, D + e, a + (m - 1));
+                if (fmpq_is_zero(x))
+                {
+                    ok = 0;
+                }
+                else
+                {
+                    fmpq_poly_evaluate_fmpz(w, N + e, a + (m - 1));
+                    fmpq_div(w, w, x);
+                    ok = fmpq_equal(w, y[m - 1] + e);
+                }
+            }
+
+            if (ok)
+                break;
+        }
+
+        target = 2 * m;
+    }
+
+    /* Write out the connection matrix */
+    for (e = 0; e < b * b; e++)
+        _fmpz_poly_q_set_fmpq_poly_frac((fmpz_poly_q_struct *) 
+            mat_entry(M, e / b, e % b, ctx), N + e, D + e);
+
+    for (i = 0; i < m; i++)
+    {
+        fmpz_clear(a + i);
+        _fmpq_vec_clear(y[i], b * b);
+    }
+    free(a);
+    free(y);
+
+    for (e = 0; e < b * b; e++)
+    {
+        fmpq_poly_clear(N + e);
+        fmpq_poly_clear(D + e);
+    }
+    free(N);
+    free(D);
+    fmpq_clear(w);
+    fmpq_clear(x);
+
+    mpoly_clear(dPdt, ctx);
+    gmc_symbolic_clear(S, ctxQ);
+    ctx_clear(ctxQ);
+}
+
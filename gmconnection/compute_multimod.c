@@ -0,0 +1,400 @@
+/******************************************************************************
+
+    Copyright (C) 2013 Sebastian Pancratz
+
+******************************************************************************/
+
+#include "flint/fmpq.h"
+#include "flint/fmpq_poly.h"
+#include "flint/fmpq_vec.h"
+#include "flint/fmpz_vec.h"
+#include "flint/nmod_poly.h"
+
+#include "flint_ex.h"
+
+#include "gmconnection.h"
+
+/*
+    Sets rop over $(\mathbf{Z}/\ell)(t)$ to the reduction of the
+    polynomial op over $\mathbf{Q}(t)$.
+
+    Returns $0$ if the reduction of one of the coefficients is not
+    defined or changes the degree of its numerator or denominator,
+    in which case the prime $\ell$ should not be used.  Returns $1$
+    otherwise.
+ */
+static int _mpoly_reduce_nmod(mpoly_t rop, const mpoly_t op, const ctx_t ctxl)
+{
+    mpoly_iter_t iter;
+    mpoly_term mt;
+    int ans = 1;
+    nmod_poly_q_struct c;
+
+    ctxl->init(ctxl, &c);
+    mpoly_zero(rop, ctxl);
+
+    mpoly_iter_init(iter, op);
+    while (ans && (mt = mpoly_iter_next(iter)))
+    {
+        const fmpz_poly_q_struct *x = (const fmpz_poly_q_struct *) mt->val;
+
+        fmpz_poly_get_nmod_poly(&c.num, x->num);
+        fmpz_poly_get_nmod_poly(&c.den, x->den);
+
+        if (nmod_poly_degree(&c.num) != fmpz_poly_degree(x->num)
+         || nmod_poly_degree(&c.den) != fmpz_poly_degree(x->den))
+        {
+            ans = 0;
+        }
+        else
+        {
+            _nmod_poly_q_canonicalise(&c);
+            mpoly_set_coeff(rop, mt->key, &c, ctxl);
+        }
+    }
+    mpoly_iter_clear(iter);
+
+    ctxl->clear(ctxl, &c);
+    return ans;
+}
+
+/*
+    Arguments for the threads computing the connection matrix modulo
+    one prime ell each.  On success, ok is set to 1 and the arrays num
+    and den of length b^2 hold the numerators and the monic denominators
+    of the entries of the connection matrix over $(\mathbf{Z}/\ell)(t)$.
+ */
+typedef struct
+{
+    mp_limb_t ell;
+    long b;
+    const __mpoly_struct *P;
+    const __mpoly_struct *dPdt;
+    int ok;
+    nmod_poly_struct *num;
+    nmod_poly_struct *den;
+    mon_t *rows;
+    mon_t *cols;
+} _gmc_multimod_arg_struct;
+
+static void * _gmc_multimod_worker(void *arg_ptr)
+{
+    _gmc_multimod_arg_struct *arg = arg_ptr;
+    const long b = arg->b;
+
+    ctx_t ctxl;
+    mpoly_t Pl, dPdtl;
+    long e;
+
+    ctx_init_nmod_poly_q(ctxl, arg->ell);
+    mpoly_init(Pl, arg->P->n, ctxl);
+    mpoly_init(dPdtl, arg->P->n, ctxl);
+
+    arg->ok = _mpoly_reduce_nmod(Pl, arg->P, ctxl)
+           && _mpoly_reduce_nmod(dPdtl, arg->dPdt, ctxl);
+
+    if (arg->ok)
+    {
+        mat_t Ml;
+
+        mat_init(Ml, b, b, ctxl);
+
+        arg->ok = !_gmc_compute(Ml, &(arg->rows), &(arg->cols), 
+                                Pl, dPdtl, 0, ctxl);
+
+        if (arg->ok)
+        {
+            arg->num = malloc(b * b * sizeof(nmod_poly_struct));
+            arg->den = malloc(b * b * sizeof(nmod_poly_struct));
+            for (e = 0; e < b * b; e++)
+            {
+                nmod_poly_q_struct *x = (nmod_poly_q_struct *)
+                                        mat_entry(Ml, e / b, e % b, ctxl);
+
+                nmod_poly_init_preinv(arg->num + e, ctxl->mod.n, ctxl->mod.ninv);
+                nmod_poly_init_preinv(arg->den + e, ctxl->mod.n, ctxl->mod.ninv);
+                nmod_poly_swap(arg->num + e, &x->num);
+                nmod_poly_swap(arg->den + e, &x->den);
+            }
+        }
+
+        mat_clear(Ml, ctxl);
+    }
+
+    mpoly_clear(Pl, ctxl);
+    mpoly_clear(dPdtl, ctxl);
+    ctx_clear(ctxl);
+
+    return NULL;
+}
+
+/*
+    Returns whether the rational number c reduces to r modulo ell.
+ */
+static int _fmpq_equal_nmod(const fmpq_t c, mp_limb_t r, nmod_t mod)
+{
+    mp_limb_t x, y;
+
+    y = fmpz_fdiv_ui(fmpq_denref(c), mod.n);
+    if (y == 0)
+        return 0;
+    x = fmpz_fdiv_ui(fmpq_numref(c), mod.n);
+    x = n_mulmod2_preinv(x, n_invmod(y, mod.n), mod.n, mod.ninv);
+
+    return x == r;
+}
+
+void gmc_compute_multimod(mat_t M, mon_t **rows, mon_t **cols,
+                          const mpoly_t P, const ctx_t ctx)
+{
+    const long b = M->m;
+    const long nt = FLINT_MAX(1, flint_parallel_num_threads());
+
+    mpoly_t dPdt;
+
+    /*
+        Reference degrees of the numerator and denominator of each entry,
+        given by the primes used so far, the residues of the coefficients
+        of all numerators and denominators in the arrays cN[e] and cD[e]
+        modulo the product mod of these primes, and the candidate
+        rational reconstructions qN[e] and qD[e], if have_q is set
+     */
+    long *degN, *degD;
+    fmpz **cN, **cD;
+    fmpq **qN, **qD;
+    fmpz_t mod;
+    int have_ref = 0, have_q = 0, done = 0;
+
+    _gmc_multimod_arg_struct *args;
+    mp_limb_t ell;
+    long e, i, t;
+
+    mpoly_init(dPdt, P->n, ctx);
+    mpoly_tderivative(dPdt, P, ctx);
+
+    degN = malloc(b * b * sizeof(long));
+    degD = malloc(b * b * sizeof(long));
+    cN   = calloc(b * b, sizeof(fmpz *));
+    cD   = calloc(b * b, sizeof(fmpz *));
+    qN   = calloc(b * b, sizeof(fmpq *));
+    qD   = calloc(b * b, sizeof(fmpq *));
+    fmpz_init(mod);
+
+    args = malloc(nt * sizeof(_gmc_multimod_arg_struct));
+
+    *rows = NULL;
+    *cols = NULL;
+
+    ell = UWORD(1) << (FLINT_BITS - 2);
+
+    while (!done)
+    {
+        /* Run one batch of primes in parallel */
+        for (t = 0; t < nt; t++)
+        {
+            ell = n_nextprime(ell, 1);
+
+            args[t].ell  = ell;
+            args[t].b    = b;
+            args[t].P    = P;
+            args[t].dPdt = dPdt;
+            args[t].num  = NULL;
+            args[t].den  = NULL;
+            args[t].rows = NULL;
+            args[t].cols = NULL;
+        }
+
+        flint_parallel_run(_gmc_multimod_worker, args, 
+                           sizeof(_gmc_multimod_arg_struct), nt);
+
+        /* Combine the results in order */
+        for (t = 0; t < nt; t++)
+        {
+            _gmc_multimod_arg_struct *arg = args + t;
+            nmod_t n;
+            long s0 = 0, s1 = 0, cmp = 0;
+
+            if (!arg->ok)
+                continue;
+
+            nmod_init(&n, arg->ell);
+
+            if (*rows)
+            {
+                free(arg->rows);
+                free(arg->cols);
+            }
+            else
+            {
+                *rows = arg->rows;
+                *cols = arg->cols;
+            }
+
+            /*
+                Compare against the reference degrees;  primes at which
+                the degrees drop are unlucky and are discarded, whereas
+                primes at which they rise replace the reference
+             */
+            if (have_ref)
+            {
+                for (e = 0; e < b * b; e++)
+                {
+                    s0 += degN[e] + degD[e];
+                    s1 += nmod_poly_degree(arg->num + e)
+                        + nmod_poly_degree(arg->den + e);
+                    if (degN[e] != nmod_poly_degree(arg->num + e) ||
+                        degD[e] != nmod_poly_degree(arg->den + e))
+                        cmp = 1;
+                }
+            }
+
+            if (!done && (!have_ref || (cmp && s1 > s0)))
+            {
+                for (e = 0; e < b * b; e++)
+                {
+                    if (cN[e])
+                    {
+                        _fmpz_vec_clear(cN[e], degN[e] + 1);
+                        _fmpz_vec_clear(cD[e], degD[e] + 1);
+                    }
+                    if (qN[e])
+                    {
+                        _fmpq_vec_clear(qN[e], degN[e] + 1);
+                        _fmpq_vec_clear(qD[e], degD[e] + 1);
+                        qN[e] = NULL;
+                        qD[e] = NULL;
+                    }
+
+                    degN[e] = nmod_poly_degree(arg->num + e);
+                    degD[e] = nmod_poly_degree(arg->den + e);
+                    cN[e] = _fmpz_vec_init(degN[e] + 1);
+                    cD[e] = _fmpz_vec_init(degD[e] + 1);
+
+                    for (i = 0; i <= degN[e]; i++)
+                        fmpz_set_ui(cN[e] + i, nmod_poly_get_coeff_ui(arg->num + e, i));
+                    for (i = 0; i <= degD[e]; i++)
+                        fmpz_set_ui(cD[e] + i, nmod_poly_get_coeff_ui(arg->den + e, i));
+                }
+                fmpz_set_ui(mod, arg->ell);
+                have_ref = 1;
+                have_q   = 0;
+            }
+            else if (!done && !cmp)
+            {
+                /* Check the candidate against this prime */
+                if (have_q)
+                {
+                    int ok = 1;
+
+                    for (e = 0; ok && e < b * b; e++)
+                    {
+                        for (i = 0; ok && i <= degN[e]; i++)
+                            ok = _fmpq_equal_nmod(qN[e] + i,
+                                     nmod_poly_get_coeff_ui(arg->num + e, i), n);
+                        for (i = 0; ok && i <= degD[e]; i++)
+                            ok = _fmpq_equal_nmod(qD[e] + i,
+                                     nmod_poly_get_coeff_ui(arg->den + e, i), n);
+                    }
+                    done = ok;
+                }
+
+                /* Chinese remaindering */
+                for (e = 0; !done && e < b * b; e++)
+                {
+                    for (i = 0; i <= degN[e]; i++)
+                        fmpz_CRT_ui(cN[e] + i, cN[e] + i, mod,
+                            nmod_poly_get_coeff_ui(arg->num + e, i), arg->ell, 0);
+                    for (i = 0; i <= degD[e]; i++)
+                        fmpz_CRT_ui(cD[e] + i, cD[e] + i, mod,
+                            nmod_poly_get_coeff_ui(arg->den + e, i), arg->ell, 0);
+                }
+                if (!done)
+                    fmpz_mul_ui(mod, mod, arg->ell);
+            }
+
+            for (e = 0; e < b * b; e++)
+            {
+                nmod_poly_clear(arg->num + e);
+                nmod_poly_clear(arg->den + e);
+            }
+            free(arg->num);
+            free(arg->den);
+        }
+
+        /* Rational reconstruction of all coefficients */
+        if (have_ref && !done)
+        {
+            int ok = 1;
+
+            for (e = 0; e < b * b; e++)
+            {
+                if (!qN[e])
+                {
+                    qN[e] = _fmpq_vec_init(degN[e] + 1);
+                    qD[e] = _fmpq_vec_init(degD[e] + 1);
+                }
+                for (i = 0; ok && i <= degN[e]; i++)
+                    ok = fmpq_reconstruct_fmpz(qN[e] + i, cN[e] + i, mod);
+                for (i = 0; ok && i <= degD[e]; i++)
+                    ok = fmpq_reconstruct_fmpz(qD[e] + i, cD[e] + i, mod);
+            }
+            have_q = ok;
+        }
+    }
+
+    /* Write out the connection matrix */
+    {
+        fmpq_poly_t N, D;
+        fmpz_poly_q_struct *x;
+
+        fmpq_poly_init(N);
+        fmpq_poly_init(D);
+
+        for (e = 0; e < b * b; e++)
+        {
+            x = (fmpz_poly_q_struct *) mat_entry(M, e / b, e % b, ctx);
+
+            if (degN[e] < 0)
+            {
+                fmpz_poly_q_zero(x);
+                continue;
+            }
+
+            fmpq_poly_zero(N);
+            for (i = 0; i <= degN[e]; i++)
+                fmpq_poly_set_coeff_fmpq(N, i, qN[e] + i);
+            fmpq_poly_zero(D);
+            for (i = 0; i <= degD[e]; i++)
+                fmpq_poly_set_coeff_fmpq(D, i, qD[e] + i);
+
+            fmpq_poly_get_numerator(x->num, N);
+            fmpz_poly_scalar_mul_fmpz(x->num, x->num, fmpq_poly_denref(D));
+            fmpq_poly_get_numerator(x->den, D);
+            fmpz_poly_scalar_mul_fmpz(x->den, x->den, fmpq_poly_denref(N));
+            fmpz_poly_q_canonicalise(x);
+        }
+
+        fmpq_poly_clear(N);
+        fmpq_poly_clear(D);
+    }
+
+    for (e = 0; e < b * b; e++)
+    {
+        _fmpz_vec_clear(cN[e], degN[e] + 1);
+        _fmpz_vec_clear(cD[e], degD[e] + 1);
+        _fmpq_vec_clear(qN[e], degN[e] + 1);
+        _fmpq_vec_clear(qD[e], degD[e] + 1);
+    }
+    free(degN);
+    free(degD);
+    free(cN);
+    free(cD);
+    free(qN);
+    free(qD);
+    fmpz_clear(mod);
+
+    free(args);
+
+    mpoly_clear(dPdt, ctx);
+}
+
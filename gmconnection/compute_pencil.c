@@ -0,0 +1,664 @@
+/******************************************************************************
+
+    Copyright (C) 2013 Sebastian Pancratz
+
+******************************************************************************/
+
+#include <gmp.h>
+
+#include "flint/fmpq.h"
+#include "flint/fmpq_poly.h"
+
+#include "flint_ex.h"
+#include "gmconnection.h"
+
+/*
+    Splits the polynomial P over $\mathbf{Q}(t)$ as P0 + t P1 with
+    P0 and P1 over $\mathbf{Q}$.  Returns $0$ if P is not of this
+    form, and $1$ otherwise.
+ */
+static int _mpoly_split_pencil(mpoly_t P0, mpoly_t P1, const mpoly_t P,
+                               const ctx_t ctxQ)
+{
+    mpoly_iter_t iter;
+    mpoly_term mt;
+    int ans = 1;
+    mpq_t c;
+    fmpz_t z;
+
+    mpq_init(c);
+    fmpz_init(z);
+    mpoly_zero(P0, ctxQ);
+    mpoly_zero(P1, ctxQ);
+
+    mpoly_iter_init(iter, P);
+    while (ans && (mt = mpoly_iter_next(iter)))
+    {
+        const fmpz_poly_q_struct *x = (const fmpz_poly_q_struct *) mt->val;
+        long i;
+
+        if (fmpz_poly_degree(x->den) != 0 || fmpz_poly_degree(x->num) > 1)
+        {
+            ans = 0;
+            break;
+        }
+
+        for (i = 0; i <= 1; i++)
+        {
+            fmpz_poly_get_coeff_fmpz(z, x->num, i);
+            if (fmpz_is_zero(z))
+                continue;
+            fmpz_get_mpz(mpq_numref(c), z);
+            fmpz_get_mpz(mpq_denref(c), x->den->coeffs + 0);
+            mpq_canonicalize(c);
+            mpoly_set_coeff(i ? P1 : P0, mt->key, c, ctxQ);
+        }
+    }
+    mpoly_iter_clear(iter);
+
+    mpq_clear(c);
+    fmpz_clear(z);
+    return ans;
+}
+
+/*
+    Sets Pa to P0 + a P1.  Returns $0$ if one of the coefficients of
+    P0 + t P1 vanishes at $t = a$, and $1$ otherwise.
+ */
+static int _mpoly_pencil_at(mpoly_t Pa, const mpoly_t P0, const mpoly_t P1,
+                            long a, const ctx_t ctxQ)
+{
+    mpoly_t T;
+    long len0 = 0, len;
+    mpoly_iter_t iter;
+    mpoly_term mt;
+
+    mpoly_init(T, P0->n, ctxQ);
+
+    mpoly_set(Pa, P1, ctxQ);
+    mpoly_scalar_mul_si(Pa, Pa, a, ctxQ);
+    mpoly_add(Pa, Pa, P0, ctxQ);
+
+    /* The number of terms of P0 + t P1 */
+    mpoly_set(T, P0, ctxQ);
+    mpoly_iter_init(iter, P1);
+    while ((mt = mpoly_iter_next(iter)))
+        mpoly_set_coeff(T, mt->key, mt->val, ctxQ);
+    mpoly_iter_clear(iter);
+
+    mpoly_iter_init(iter, T);
+    while (mpoly_iter_next(iter))
+        len0++;
+    mpoly_iter_clear(iter);
+
+    len = 0;
+    mpoly_iter_init(iter, Pa);
+    while (mpoly_iter_next(iter))
+        len++;
+    mpoly_iter_clear(iter);
+
+    mpoly_clear(T, ctxQ);
+
+    return len == len0;
+}
+
+/*
+    Reduces the series Q0 = \sum_j Q0_j s^j at level k modulo s^m,
+    where the coefficients Q0_j are stored as consecutive vectors of
+    length L0[k]->len, with respect to the pencil P0 + s P1.
+
+    The levels L0 and L1 hold the index operators for the derivatives
+    of P0 and P1, and the auxiliary matrix at level k is A0[k] + s A1[k],
+    where s0[k] is the factorisation of A0[k].  Writing x = \sum_j x_j s^j
+    for the solution of (A0 + s A1) x = b, we have A0 x_0 = b_0 and
+    A0 x_j = b_j - A1 x_{j-1}, so that only the constant part is
+    ever factored.
+
+    Sets R[i] to the m coefficients, each of length L0[i]->lenB, of
+    the reduction at level i, for l <= i <= u.
+ */
+static void _gmc_reduce_pencil(char **R, const char *Q0, long k, long m,
+                               gmc_level_t *L0, gmc_level_t *L1,
+                               mat_csr_solve_t *s0, mat_csr_t *A1,
+                               long l, long u, const ctx_t ctx)
+{
+    const long len = L0[k]->len;
+
+    long h, i, j, q, lenx, lenb;
+    char *Q, *Q1, *x, *b, *c, *t;
+
+    lenx = 1;
+    lenb = 1;
+    for (i = 1; i <= k; i++)
+    {
+        lenx = FLINT_MAX(lenx, L0[i]->ncols);
+        lenb = FLINT_MAX(lenb, L0[i]->lenN);
+    }
+
+    Q  = _vec_init(m * len, ctx);
+    Q1 = _vec_init(m * len, ctx);
+    x  = _vec_init(m * lenx, ctx);
+    b  = _vec_init(lenb, ctx);
+    c  = _vec_init(lenb, ctx);
+    t  = malloc(ctx->size);
+    ctx->init(ctx, t);
+
+    _vec_set(Q, Q0, m * L0[k]->len, ctx);
+
+    for (i = FLINT_MAX(k + 1, l); i <= u; i++)
+        if (L0[i]->lenB > 0)
+            _vec_zero(R[i], m * L0[i]->lenB, ctx);
+
+    while (1)
+    {
+        const __gmc_level_struct *Lk = L0[k];
+        const __gmc_level_struct *Mk = L1[k];
+        const __gmc_level_struct *Lm = L0[k - 1];
+        int in_basis = 1;
+
+        for (h = 0; in_basis && h < m; h++)
+            for (i = 0; in_basis && i < Lk->lenN; i++)
+                if (!ctx->is_zero(ctx, Q + (h * Lk->len + Lk->N[i]) * ctx->size))
+                    in_basis = 0;
+
+        if (in_basis)
+            break;
+
+        /* Solve (A0 + s A1) x = b coefficient by coefficient */
+        for (h = 0; h < m; h++)
+        {
+            char *xh = x + h * Lk->ncols * ctx->size;
+
+            for (i = 0; i < Lk->lenN; i++)
+                ctx->set(ctx, b + i * ctx->size,
+                              Q + (h * Lk->len + Lk->N[i]) * ctx->size);
+            if (h > 0)
+            {
+                mat_csr_mul_vec(c, A1[k], xh - Lk->ncols * ctx->size, ctx);
+                _vec_sub(b, b, c, Lk->lenN, ctx);
+            }
+            mat_csr_solve(xh, s0[k], b, ctx);
+        }
+
+        /* R[k] := Q - \sum_{var} A_{var} (dP0_{var} + s dP1_{var}) */
+        if (k <= u)
+        {
+            for (h = 0; h < m; h++)
+                for (i = 0; i < Lk->lenB; i++)
+                    ctx->set(ctx, R[k] + (h * Lk->lenB + i) * ctx->size,
+                                  Q + (h * Lk->len + Lk->B[i]) * ctx->size);
+
+            for (h = 0; h < m; h++)
+            {
+                char *Rh = R[k] + h * Lk->lenB * ctx->size;
+                const char *xh = x + h * Lk->ncols * ctx->size;
+
+                for (j = 0; j < Lk->ncols; j++)
+                {
+                    if (ctx->is_zero(ctx, xh + j * ctx->size))
+                        continue;
+                    for (q = Lk->mulp[j]; q < Lk->mulp[j + 1]; q++)
+                    {
+                        char *r = Rh + Lk->muli[q] * ctx->size;
+
+                        ctx->mul(ctx, t, xh + j * ctx->size, Lk->mulx + q * ctx->size);
+                        ctx->sub(ctx, r, r, t);
+                    }
+                }
+
+                if (h + 1 < m)
+                {
+                    Rh += Lk->lenB * ctx->size;
+
+                    for (j = 0; j < Mk->ncols; j++)
+                    {
+                        if (ctx->is_zero(ctx, xh + j * ctx->size))
+                            continue;
+                        for (q = Mk->mulp[j]; q < Mk->mulp[j + 1]; q++)
+                        {
+                            char *r = Rh + Mk->muli[q] * ctx->size;
+
+                            ctx->mul(ctx, t, xh + j * ctx->size, Mk->mulx + q * ctx->size);
+                            ctx->sub(ctx, r, r, t);
+                        }
+                    }
+                }
+            }
+        }
+
+        /* Q := \sum_{var} d/dX_{var} A_{var} / (k - 1) */
+        if (Lm->len > 0)
+        {
+            _vec_zero(Q1, m * Lm->len, ctx);
+
+            for (h = 0; h < m; h++)
+            {
+                const char *xh = x + h * Lk->ncols * ctx->size;
+                char *Qh = Q1 + h * Lm->len * ctx->size;
+
+                for (j = 0; j < Lk->ncols; j++)
+                {
+                    if (Lk->dpos[j] < 0 || ctx->is_zero(ctx, xh + j * ctx->size))
+                        continue;
+
+                    ctx->set_si(ctx, t, Lk->dexp[j]);
+                    ctx->mul(ctx, t, t, xh + j * ctx->size);
+                    ctx->add(ctx, Qh + Lk->dpos[j] * ctx->size,
+                                  Qh + Lk->dpos[j] * ctx->size, t);
+                }
+            }
+
+            ctx->set_si(ctx, t, k - 1);
+            for (i = 0; i < m * Lm->len; i++)
+                ctx->div(ctx, Q1 + i * ctx->size, Q1 + i * ctx->size, t);
+        }
+
+        k--;
+        {
+            char *T = Q; Q = Q1; Q1 = T;
+        }
+    }
+
+    /*
+        Set the last element Q, which we know lies in the basis, noting
+        that R[k] was zeroed above only when k > u
+     */
+    if (l <= k && k <= u)
+    {
+        for (h = 0; h < m; h++)
+            for (i = 0; i < L0[k]->lenB; i++)
+                ctx->set(ctx, R[k] + (h * L0[k]->lenB + i) * ctx->size,
+                              Q + (h * L0[k]->len + L0[k]->B[i]) * ctx->size);
+    }
+
+    for (k = FLINT_MIN(k, u + 1) - 1; k >= l; k--)
+        if (L0[k]->lenB > 0)
+            _vec_zero(R[k], m * L0[k]->lenB, ctx);
+
+    _vec_clear(Q, m * len, ctx);
+    _vec_clear(Q1, m * len, ctx);
+    _vec_clear(x, m * lenx, ctx);
+    _vec_clear(b, lenb, ctx);
+    _vec_clear(c, lenb, ctx);
+    ctx->clear(ctx, t);
+    free(t);
+}
+
+/*
+    Returns a bound for the degree in s of det(A0 + s A1) for square 
+    matrices A0 and A1, namely the smaller of the numbers of non-zero 
+    rows and columns of A1, as the determinant is linear in each row 
+    and each column.
+ */
+static long _gmc_pencil_det_degree(const mat_csr_t A1, const ctx_t ctx)
+{
+    long i, q, nrows = 0, ncols = 0;
+    char *c;
+
+    c = calloc(FLINT_MAX(A1->n, 1), 1);
+
+    for (i = 0; i < A1->m; i++)
+    {
+        int nz = 0;
+
+        for (q = A1->p[i]; q < A1->p[i] + A1->lenr[i]; q++)
+            if (!ctx->is_zero(ctx, A1->x + q * ctx->size))
+            {
+                nz = 1;
+                c[A1->j[q]] = 1;
+            }
+        nrows += nz;
+    }
+    for (i = 0; i < A1->n; i++)
+        ncols += c[i];
+
+    free(c);
+
+    return FLINT_MIN(nrows, ncols);
+}
+
+/*
+    Given the pencil P0 + t P1 over $\mathbf{Q}$ with P1 non-zero, sets 
+    N + e and D + e to the numerator and the monic denominator of the 
+    entries of the connection matrix as functions of s = t - a, where 
+    a is the point around which the expansion is computed.
+ */
+static void _gmc_pencil_series(fmpq_poly_struct *N, fmpq_poly_struct *D, 
+                               long *a_out, const mpoly_t P0, const mpoly_t P1, 
+                               const mon_t *B, const long *iB, long lenB, 
+                               long l, long u, long n, long d, 
+                               const ctx_t ctxQ)
+{
+    const long k0 = (n + (d - 1)) / d + 1;
+
+    mpoly_t Pa, *dP0, *dP1;
+    gmc_level_t *L0, *L1;
+    mat_csr_t *A0, *A1;
+    mat_csr_solve_t *s0;
+    long a, delta, next, e, h, i, j, k, m;
+
+    mpoly_init(Pa, n + 1, ctxQ);
+
+    dP0 = malloc((n + 1) * sizeof(mpoly_t));
+    dP1 = malloc((n + 1) * sizeof(mpoly_t));
+    for (i = 0; i <= n; i++)
+    {
+        mpoly_init(dP0[i], n + 1, ctxQ);
+        mpoly_init(dP1[i], n + 1, ctxQ);
+    }
+    gmc_derivatives(dP1, P1, ctxQ);
+
+    L0 = malloc((u + 2) * sizeof(gmc_level_t));
+    L1 = malloc((u + 2) * sizeof(gmc_level_t));
+    A0 = malloc((u + 2) * sizeof(mat_csr_t));
+    A1 = malloc((u + 2) * sizeof(mat_csr_t));
+    s0 = malloc((u + 2) * sizeof(mat_csr_solve_t));
+
+    /*
+        Expand around the first point a in 0, 1, -1, 2, -2, ... at which
+        the auxiliary matrices of P0 + a P1 are invertible, writing
+        s = t - a, so that P = (P0 + a P1) + s P1
+     */
+    for (next = 0; ; next++)
+    {
+        int fail = 0;
+
+        a = (next % 2) ? (next + 1) / 2 : - (next / 2);
+
+        if (!_mpoly_pencil_at(Pa, P0, P1, a, ctxQ))
+            continue;
+
+        gmc_derivatives(dP0, Pa, ctxQ);
+
+        for (k = 0; k <= u + 1; k++)
+        {
+            gmc_level_init(L0[k], n, d, k);
+            gmc_level_init(L1[k], n, d, k);
+        }
+
+        for (k = k0; k <= u + 1; k++)
+        {
+            mon_t *r, *c;
+            long *p = malloc((n + 2) * sizeof(long));
+
+            gmc_init_auxmatrix(A0[k], &r, &c, p, Pa, k, ctxQ);
+            free(r);
+            free(c);
+            gmc_init_auxmatrix(A1[k], &r, &c, p, P1, k, ctxQ);
+
+            fail |= mat_csr_solve_init(s0[k], A0[k], ctxQ);
+
+            gmc_level_set_ops(L0[k], L0[k - 1], dP0, c, p, ctxQ);
+            gmc_level_set_ops(L1[k], L1[k - 1], dP1, c, p, ctxQ);
+
+            free(r);
+            free(c);
+            free(p);
+        }
+
+        if (!fail)
+            break;
+
+        for (k = k0; k <= u + 1; k++)
+        {
+            mat_csr_clear(A0[k], ctxQ);
+            mat_csr_clear(A1[k], ctxQ);
+            mat_csr_solve_clear(s0[k], ctxQ);
+        }
+        for (k = 0; k <= u + 1; k++)
+        {
+            gmc_level_clear(L0[k], ctxQ);
+            gmc_level_clear(L1[k], ctxQ);
+        }
+    }
+
+    /*
+        Each step of the reduction solves with A0 + s A1, whose 
+        determinant has degree at most delta_k, and multiplies by the 
+        partial derivatives of P, which are linear in s.  Since dP/dt 
+        is constant in s, every entry of M is of the form N* / D* with 
+        deg D* <= delta and deg N* <= delta + 1, where delta is the sum 
+        of the delta_k over all levels.
+
+        Compute the expansion of M in s modulo s^m and recover the 
+        entries N / D by Pade approximation.  Since N D* - N* D then 
+        vanishes modulo s^m and has degree at most 
+        max(deg N + delta, deg D + delta + 1), the candidate is 
+        correct once m exceeds this bound;  otherwise, double m.
+     */
+    delta = 0;
+    for (k = k0; k <= u + 1; k++)
+        delta += _gmc_pencil_det_degree(A1[k], ctxQ);
+
+    for (m = 16; m < delta + 2; m *= 2) ;
+
+    for ( ; ; m *= 2)
+    {
+        char *S, *Q, **R, *x;
+        fmpq_poly_t C, Z;
+        int ok = 1;
+
+        S = _vec_init(m * lenB * lenB, ctxQ);
+        Q = _vec_init(m * L0[u + 1]->len, ctxQ);
+        R = malloc((u + 1) * sizeof(char *));
+        for (i = l; i <= u; i++)
+            R[i] = (L0[i]->lenB > 0) ? _vec_init(m * L0[i]->lenB, ctxQ) : NULL;
+        x = _vec_init(1, ctxQ);
+
+        for (j = 0; j < lenB; j++)
+        {
+            mpoly_iter_t iter;
+            mpoly_term mt;
+            long colk, rowk;
+
+            colk = l;
+            while (iB[colk + 1] <= j)
+                colk++;
+
+            /* Set Q to -colk B[j] dP/dt, which is constant in s */
+            _vec_zero(Q, m * L0[colk + 1]->len, ctxQ);
+            ctxQ->set_si(ctxQ, x, -colk);
+            mpoly_iter_init(iter, P1);
+            while ((mt = mpoly_iter_next(iter)))
+            {
+                mon_t mm;
+
+                mon_mul(mm, mt->key, B[j]);
+                ctxQ->mul(ctxQ, Q + gmc_level_rank(L0[colk + 1], mm) * ctxQ->size,
+                                x, mt->val);
+            }
+            mpoly_iter_clear(iter);
+
+            _gmc_reduce_pencil(R, Q, colk + 1, m, L0, L1, s0, A1, l, u, ctxQ);
+
+            for (rowk = l; rowk <= FLINT_MIN(u, colk + 1); rowk++)
+                for (i = iB[rowk]; i < iB[rowk + 1]; i++)
+                    for (h = 0; h < m; h++)
+                        ctxQ->set(ctxQ, S + ((i * lenB + j) * m + h) * ctxQ->size,
+                            R[rowk] + (h * L0[rowk]->lenB + (i - iB[rowk])) * ctxQ->size);
+        }
+
+        fmpq_poly_init(C);
+        fmpq_poly_init(Z);
+        fmpq_poly_set_coeff_si(Z, m, 1);
+
+        for (e = 0; ok && e < lenB * lenB; e++)
+        {
+            fmpq_t c;
+
+            fmpq_init(c);
+            fmpq_poly_zero(C);
+            for (h = 0; h < m; h++)
+            {
+                fmpq_set_mpq(c, (__mpq_struct *) (S + (e * m + h) * ctxQ->size));
+                fmpq_poly_set_coeff_fmpq(C, h, c);
+            }
+
+            /* N/D from C modulo s^m, with D invertible as a series */
+            ok = fmpq_poly_ratrecon(N + e, D + e, C, Z, (m + 1) / 2);
+
+            if (ok)
+            {
+                fmpq_poly_get_coeff_fmpq(c, D + e, 0);
+                ok = !fmpq_is_zero(c);
+            }
+            if (ok)
+            {
+                ok = (m > FLINT_MAX(fmpq_poly_degree(N + e) + delta, 
+                                    fmpq_poly_degree(D + e) + delta + 1));
+            }
+
+            fmpq_clear(c);
+        }
+
+        fmpq_poly_clear(C);
+        fmpq_poly_clear(Z);
+
+        _vec_clear(S, m * lenB * lenB, ctxQ);
+        _vec_clear(Q, m * L0[u + 1]->len, ctxQ);
+        for (i = l; i <= u; i++)
+            if (L0[i]->lenB > 0)
+                _vec_clear(R[i], m * L0[i]->lenB, ctxQ);
+        free(R);
+        _vec_clear(x, 1, ctxQ);
+
+        if (ok)
+            break;
+    }
+
+    for (k = k0; k <= u + 1; k++)
+    {
+        mat_csr_clear(A0[k], ctxQ);
+        mat_csr_clear(A1[k], ctxQ);
+        mat_csr_solve_clear(s0[k], ctxQ);
+    }
+    for (k = 0; k <= u + 1; k++)
+    {
+        gmc_level_clear(L0[k], ctxQ);
+        gmc_level_clear(L1[k], ctxQ);
+    }
+    free(L0);
+    free(L1);
+    free(A0);
+    free(A1);
+    free(s0);
+
+    for (i = 0; i <= n; i++)
+    {
+        mpoly_clear(dP0[i], ctxQ);
+        mpoly_clear(dP1[i], ctxQ);
+    }
+    free(dP0);
+    free(dP1);
+
+    mpoly_clear(Pa, ctxQ);
+    *a_out = a;
+}
+
+void gmc_compute_pencil(mat_t M, mon_t **rows, mon_t **cols,
+                        const mpoly_t P, const ctx_t ctx)
+{
+    const long n = P->n - 1;
+    const long d = mpoly_degree(P, -1, ctx);
+
+    ctx_t ctxQ;
+    mpoly_t P0, P1;
+
+    mon_t *B;
+    long *iB, l, u, lenB;
+
+    long a, e, i;
+    fmpq_poly_struct *N, *D;
+
+    ctx_init_mpq(ctxQ);
+
+    mpoly_init(P0, n + 1, ctxQ);
+    mpoly_init(P1, n + 1, ctxQ);
+
+    if (!_mpoly_split_pencil(P0, P1, P, ctxQ))
+    {
+        printf("ERROR (gmc_compute_pencil).  P is not linear in t.\n\n");
+        abort();
+    }
+
+    gmc_basis_sets(&B, &iB, &lenB, &l, &u, n, d);
+
+    N = malloc(lenB * lenB * sizeof(fmpq_poly_struct));
+    D = malloc(lenB * lenB * sizeof(fmpq_poly_struct));
+    for (e = 0; e < lenB * lenB; e++)
+    {
+        fmpq_poly_init(N + e);
+        fmpq_poly_init(D + e);
+    }
+
+    /* The connection matrix vanishes if P does not depend on t */
+    if (mpoly_is_zero(P1, ctxQ))
+    {
+        for (e = 0; e < lenB * lenB; e++)
+            fmpq_poly_one(D + e);
+        a = 0;
+    }
+    else
+    {
+        _gmc_pencil_series(N, D, &a, P0, P1, B, iB, lenB, l, u, n, d, ctxQ);
+    }
+
+    /* Substitute s = t - a and write out the connection matrix */
+    {
+        fmpq_poly_t lin;
+
+        fmpq_poly_init(lin);
+        fmpq_poly_set_coeff_si(lin, 1, 1);
+        fmpq_poly_set_coeff_si(lin, 0, -a);
+
+        for (e = 0; e < lenB * lenB; e++)
+        {
+            fmpz_poly_q_struct *y = (fmpz_poly_q_struct *)
+                                    mat_entry(M, e / lenB, e % lenB, ctx);
+
+            if (fmpq_poly_is_zero(N + e))
+            {
+                fmpz_poly_q_zero(y);
+                continue;
+            }
+
+            if (a != 0)
+            {
+                fmpq_poly_compose(N + e, N + e, lin);
+                fmpq_poly_compose(D + e, D + e, lin);
+            }
+
+            fmpq_poly_get_numerator(y->num, N + e);
+            fmpz_poly_scalar_mul_fmpz(y->num, y->num, fmpq_poly_denref(D + e));
+            fmpq_poly_get_numerator(y->den, D + e);
+            fmpz_poly_scalar_mul_fmpz(y->den, y->den, fmpq_poly_denref(N + e));
+            fmpz_poly_q_canonicalise(y);
+        }
+
+        fmpq_poly_clear(lin);
+    }
+
+    *rows = malloc(lenB * sizeof(mon_t));
+    *cols = malloc(lenB * sizeof(mon_t));
+    for (i = 0; i < lenB; i++)
+    {
+        (*rows)[i] = B[i];
+        (*cols)[i] = B[i];
+    }
+
+    for (e = 0; e < lenB * lenB; e++)
+    {
+        fmpq_poly_clear(N + e);
+        fmpq_poly_clear(D + e);
+    }
+    free(N);
+    free(D);
+
+    free(B);
+    free(iB);
+
+    mpoly_clear(P0, ctxQ);
+    mpoly_clear(P1, ctxQ);
+    ctx_clear(ctxQ);
+}
+
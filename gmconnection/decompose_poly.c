@@ -6,21 +6,26 @@
 
 #include "gmconnection.h"
 
-void gmc_decompose_poly(mpoly_t * A, const mpoly_t poly, 
-                        const mat_csr_solve_t s, 
-                        mon_t * const rows, 
-                        mon_t * const cols, 
-                        long * const p, 
-                        const ctx_t ctx)
+long _gmc_decompose_poly_worklen(const mat_csr_solve_t s)
+{
+    return s->m + s->n + _mat_csr_solve_worklen(s, 1);
+}
+
+void _gmc_decompose_poly(mpoly_t * A, const mpoly_t poly, 
+                         const mat_csr_solve_t s, 
+                         mon_t * const rows, 
+                         mon_t * const cols, 
+                         long * const p, 
+                         char *W, const ctx_t ctx)
 {
     char *x, *b;
     long j, var;
 
-    x = _vec_init(s->m, ctx);
-    b = _vec_init(s->n, ctx);
+    x = W;
+    b = x + s->m * ctx->size;
 
     gmc_poly2array(b, poly, rows, s->n, ctx);
-    mat_csr_solve(x, s, b, ctx);
+    _mat_csr_solve_mat(x, s, b, 1, b + s->n * ctx->size, ctx);
 
     for (var = 0; var < poly->n; var++)
     {
@@ -28,8 +33,21 @@ void gmc_decompose_poly(mpoly_t * A, const mpoly_t poly,
         for (j = p[var]; j < p[var + 1]; j++)
             mpoly_add_coeff(A[var], cols[j], x + j * ctx->size, ctx);
     }
+}
+
+void gmc_decompose_poly(mpoly_t * A, const mpoly_t poly, 
+                        const mat_csr_solve_t s, 
+                        mon_t * const rows, 
+                        mon_t * const cols, 
+                        long * const p, 
+                        const ctx_t ctx)
+{
+    const long lenW = _gmc_decompose_poly_worklen(s);
+
+    char *W;
 
-    _vec_clear(x, s->m, ctx);
-    _vec_clear(b, s->n, ctx);
+    W = _vec_init(lenW, ctx);
+    _gmc_decompose_poly(A, poly, s, rows, cols, p, W, ctx);
+    _vec_clear(W, lenW, ctx);
 }
 
@@ -0,0 +1,51 @@
+/******************************************************************************
+
+    Copyright (C) 2013 Sebastian Pancratz
+ 
+******************************************************************************/
+
+#include "gmconnection.h"
+
+void gmc_decompose_polys(mpoly_t ** A, const mpoly_t * polys, long r, 
+                         const mat_csr_solve_t s, 
+                         mon_t * const rows, 
+                         mon_t * const cols, 
+                         long * const p, 
+                         const ctx_t ctx)
+{
+    char *X, *B, *b;
+    long c, i, j, var;
+
+    if (r < 1)
+        return;
+
+    X = _vec_init(s->m * r, ctx);
+    B = _vec_init(s->n * r, ctx);
+    b = _vec_init(s->n, ctx);
+
+    /* Assemble the right-hand sides as the columns of B */
+    for (c = 0; c < r; c++)
+    {
+        gmc_poly2array(b, polys[c], rows, s->n, ctx);
+        for (i = 0; i < s->n; i++)
+            ctx->swap(ctx, B + (i * r + c) * ctx->size, b + i * ctx->size);
+    }
+
+    mat_csr_solve_mat(X, s, B, r, ctx);
+
+    for (c = 0; c < r; c++)
+    {
+        for (var = 0; var < polys[c]->n; var++)
+        {
+            mpoly_zero(A[c][var], ctx);
+            for (j = p[var]; j < p[var + 1]; j++)
+                mpoly_add_coeff(A[c][var], cols[j], 
+                                X + (j * r + c) * ctx->size, ctx);
+        }
+    }
+
+    _vec_clear(X, s->m * r, ctx);
+    _vec_clear(B, s->n * r, ctx);
+    _vec_clear(b, s->n, ctx);
+}
+
@@ -34,18 +34,34 @@ static long gmc_bsearch(const mon_t *a, long l, long u, const mon_t x)
     return -1;
 }
 
-/* Expects uninitialised matrix M, and p of length n + 1. */
+/*
+    Returns whether the monomial f has some exponent at least d - 1, 
+    that is, whether it is one of the row indices.
+ */
+static int gmc_mon_in_rows(mon_t f, long d)
+{
+    while (f)
+    {
+        if ((f & MON_BITMASK_BLOCK) >= d - 1)
+            return 1;
+        f >>= MON_BITS_PER_EXP;
+    }
+    return 0;
+}
 
-void gmc_init_auxmatrix(mat_csr_t M, 
-                        mon_t **R, mon_t **C, long *p, 
-                        const mpoly_t P, long k, 
-                        const ctx_t ctx)
+/*
+    Expects uninitialised matrix M, and p of length n + 1.  The array 
+    DP contains the n partial derivatives of a polynomial of degree d.
+ */
+
+void _gmc_init_auxmatrix(mat_csr_t M, 
+                         mon_t **R, mon_t **C, long *p, 
+                         mpoly_t *DP, long d, long k, 
+                         const ctx_t ctx)
 {
-    const long d = mpoly_degree(P, -1, ctx);
-    const long n = P->n;
+    const long n = DP[0]->n;
 
     long i, j, var;
-    mpoly_t *DP;
     mon_t *rows, *cols;
     long nrows, ncols;
 
@@ -58,13 +74,6 @@ void gmc_init_auxmatrix(mat_csr_t M,
     assert((1 <= k) && (k <= n));
     assert((k - 1) * d >= n - 1);
     
-    DP = malloc(n * sizeof(mpoly_t));
-    for (var = 0; var < n; var++)
-    {
-        mpoly_init(DP[var], n, ctx);
-        mpoly_derivative(DP[var], P, var, ctx);
-    }
-    
     /* Step 1.  Compute the row and column index sets */
     {
         mon_t *rows0, *cols0;
@@ -92,8 +101,25 @@ void gmc_init_auxmatrix(mat_csr_t M,
             mon_clear(rows0[i]);
         }
         
-        /* Setting up the columns */
-        cols  = malloc(nrows * sizeof(mon_t));
+        /*
+            Setting up the columns, where the block for var consists of 
+            the monomials in cols0 with exponents at most d - 2 in all 
+            the variables before var;  we first count the total length
+         */
+        ncols = 0;
+        for (j = 0; j < ncols0; j++)
+        {
+            ncols++;
+            for (var = 1; var < n; var++)
+            {
+                if (mon_get_exp(cols0[j], var - 1) < d - 1)
+                    ncols++;
+                else
+                    break;
+            }
+        }
+
+        cols  = malloc(ncols * sizeof(mon_t));
         ncols = 0;
         p[0]  = 0;
         for (j = 0; j < ncols0; j++)
@@ -120,53 +146,59 @@ void gmc_init_auxmatrix(mat_csr_t M,
         free(cols0);
     }
 
-    /* Step 2.  Set-up the auxiliary matrix */
+    /*
+        Step 2.  Set-up the auxiliary matrix
+
+        We make two passes over the columns, first counting the number 
+        of non-zero entries so that the staging array for the triples 
+        is of the same size as the resulting matrix.
+     */
     {
-        mem = malloc(u * nrows * nrows);
-        c = 0;
+        long pass;
+
+        mem = NULL;
 
-        for (j = 0; j < n; j++)
+        for (pass = 0; pass < 2; pass++)
         {
-            long q;
+            c = 0;
 
-            for (q = p[j]; q < p[j + 1]; q++)
+            for (j = 0; j < n; j++)
             {
-                mpoly_iter_t iter;
-                mpoly_term mt;
+                long q;
 
-                /* Look at the column (j, cols[q]) */
-                mpoly_iter_init(iter, DP[j]);
-                while ((mt = mpoly_iter_next(iter)))
+                for (q = p[j]; q < p[j + 1]; q++)
                 {
-                    mon_t f;
-                    int f_is_in_rows;
+                    mpoly_iter_t iter;
+                    mpoly_term mt;
 
-                    mon_mul(f, mt->key, cols[q]);
-                    f_is_in_rows = 0;
-                    while (f)
-                    {
-                        if ((f & MON_BITMASK_BLOCK) >= d - 1)
-                        {
-                            f_is_in_rows = 1;
-                            break;
-                        }
-                        f >>= MON_BITS_PER_EXP;
-                    }
-                    if (f_is_in_rows)
+                    /* Look at the column (j, cols[q]) */
+                    mpoly_iter_init(iter, DP[j]);
+                    while ((mt = mpoly_iter_next(iter)))
                     {
+                        mon_t f;
+
                         mon_mul(f, mt->key, cols[q]);
-                        i = gmc_bsearch(rows, 0, nrows - 1, f);
+                        if (!gmc_mon_in_rows(f, d))
+                            continue;
+
+                        if (pass == 1)
+                        {
+                            i = gmc_bsearch(rows, 0, nrows - 1, f);
 
-                        /* Add the entry mt->value in position (i, q) */
-                        *(long *) (mem + c * u) = i;
-                        *(long *) (mem + c * u + sizeof(long)) = q;
-                        ctx->init(ctx, mem + c * u + 2 * sizeof(long));
-                        ctx->set(ctx, mem + c * u + 2 * sizeof(long), mt->val);
+                            /* Add the entry mt->value in position (i, q) */
+                            *(long *) (mem + c * u) = i;
+                            *(long *) (mem + c * u + sizeof(long)) = q;
+                            ctx->init(ctx, mem + c * u + 2 * sizeof(long));
+                            ctx->set(ctx, mem + c * u + 2 * sizeof(long), mt->val);
+                        }
                         c++;
                     }
+                    mpoly_iter_clear(iter);
                 }
-                mpoly_iter_clear(iter);
             }
+
+            if (pass == 0)
+                mem = malloc(u * FLINT_MAX(c, 1));
         }
 
         mat_csr_init2(M, nrows, ncols, c, ctx);
@@ -177,10 +209,30 @@ void gmc_init_auxmatrix(mat_csr_t M,
     /* Copy output */
     *R  = rows;
     *C  = cols;
+}
 
-    /* Cleaning up */
-    for (i = 0; i < n; i++)
-        mpoly_clear(DP[i], ctx);
+void gmc_init_auxmatrix(mat_csr_t M, 
+                        mon_t **R, mon_t **C, long *p, 
+                        const mpoly_t P, long k, 
+                        const ctx_t ctx)
+{
+    const long d = mpoly_degree(P, -1, ctx);
+    const long n = P->n;
+
+    long var;
+    mpoly_t *DP;
+
+    DP = malloc(n * sizeof(mpoly_t));
+    for (var = 0; var < n; var++)
+    {
+        mpoly_init(DP[var], n, ctx);
+        mpoly_derivative(DP[var], P, var, ctx);
+    }
+
+    _gmc_init_auxmatrix(M, R, C, p, DP, d, k, ctx);
+
+    for (var = 0; var < n; var++)
+        mpoly_clear(DP[var], ctx);
     free(DP);
 }
 
@@ -0,0 +1,25 @@
+/******************************************************************************
+
+    Copyright (C) 2013 Sebastian Pancratz
+ 
+******************************************************************************/
+
+#include "gmconnection.h"
+
+void gmc_level_clear(gmc_level_t L, const ctx_t ctx)
+{
+    free(L->mon);
+    free(L->B);
+    free(L->N);
+
+    if (L->ncols > 0)
+    {
+        if (L->mulp[L->ncols] > 0)
+            _vec_clear(L->mulx, L->mulp[L->ncols], ctx);
+        free(L->dpos);
+        free(L->dexp);
+        free(L->mulp);
+        free(L->muli);
+    }
+}
+
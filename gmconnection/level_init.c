@@ -0,0 +1,52 @@
+/******************************************************************************
+
+    Copyright (C) 2013 Sebastian Pancratz
+ 
+******************************************************************************/
+
+#include "gmconnection.h"
+
+void gmc_level_init(gmc_level_t L, long n, long d, long k)
+{
+    const long deg = k * d - (n + 1);
+    long i, var;
+
+    L->n = n;
+    L->d = d;
+    L->k = k;
+
+    if (deg >= 0)
+    {
+        L->mon = mon_generate_by_degree_invlex(&(L->len), n + 1, deg);
+    }
+    else
+    {
+        L->mon = NULL;
+        L->len = 0;
+    }
+
+    L->B    = malloc(L->len * sizeof(long));
+    L->N    = malloc(L->len * sizeof(long));
+    L->lenB = 0;
+    L->lenN = 0;
+
+    for (i = 0; i < L->len; i++)
+    {
+        for (var = 0; var <= n; var++)
+            if (mon_get_exp(L->mon[i], var) >= d - 1)
+                break;
+
+        if (var == n + 1)
+            L->B[(L->lenB)++] = i;
+        else
+            L->N[(L->lenN)++] = i;
+    }
+
+    L->ncols = 0;
+    L->dpos  = NULL;
+    L->dexp  = NULL;
+    L->mulp  = NULL;
+    L->muli  = NULL;
+    L->mulx  = NULL;
+}
+
@@ -0,0 +1,25 @@
+/******************************************************************************
+
+    Copyright (C) 2013 Sebastian Pancratz
+ 
+******************************************************************************/
+
+#include "gmconnection.h"
+
+long gmc_level_rank(const gmc_level_t L, mon_t m)
+{
+    long l = 0, u = L->len - 1, i;
+
+    while (l <= u)
+    {
+        i = l + ((u - l) >> 1);
+        if (m < L->mon[i])
+            u = i - 1;
+        else if (m > L->mon[i])
+            l = i + 1;
+        else
+            return i;
+    }
+    return -1;
+}
+
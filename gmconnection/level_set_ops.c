@@ -0,0 +1,135 @@
+/******************************************************************************
+
+    Copyright (C) 2013 Sebastian Pancratz
+ 
+******************************************************************************/
+
+#include <assert.h>
+
+#include "gmconnection.h"
+
+/*
+    Returns the index of the monomial of rank r in the list of basis 
+    monomials of L, or -1 if it is not a basis monomial.
+ */
+static long _gmc_level_basis_index(const gmc_level_t L, long r)
+{
+    long l = 0, u = L->lenB - 1, i;
+
+    while (l <= u)
+    {
+        i = l + ((u - l) >> 1);
+        if (r < L->B[i])
+            u = i - 1;
+        else if (r > L->B[i])
+            l = i + 1;
+        else
+            return i;
+    }
+    return -1;
+}
+
+/*
+    Sets up the index operators for the columns of the auxiliary matrix 
+    at level k, given by the arrays cols and p as returned by 
+    gmc_init_auxmatrix(), where L1 is the level k - 1.
+
+    The multiplication operator only retains the terms of cols[j] dP_var 
+    which are basis monomials, since the remaining ones are cancelled 
+    exactly by the solution of the auxiliary system.
+ */
+void gmc_level_set_ops(gmc_level_t L, const gmc_level_t L1, mpoly_t *dP, 
+                       const mon_t *cols, const long *p, const ctx_t ctx)
+{
+    const long n = L->n;
+    const long d = L->d;
+
+    long j, var, c;
+
+    assert(L1->k == L->k - 1);
+
+    L->ncols = p[n + 1];
+    if (L->ncols == 0)
+        return;
+
+    L->dpos = malloc(L->ncols * sizeof(long));
+    L->dexp = malloc(L->ncols * sizeof(long));
+    L->mulp = malloc((L->ncols + 1) * sizeof(long));
+
+    /* Derivative operator, and the lengths of the multiplication operator */
+    for (var = 0; var <= n; var++)
+    {
+        for (j = p[var]; j < p[var + 1]; j++)
+        {
+            mpoly_iter_t iter;
+            mpoly_term mt;
+            mon_t m;
+
+            L->dexp[j] = mon_get_exp(cols[j], var);
+            if (L->dexp[j] > 0)
+            {
+                mon_set(m, cols[j]);
+                mon_dec_exp(m, var, 1);
+                L->dpos[j] = gmc_level_rank(L1, m);
+            }
+            else
+            {
+                L->dpos[j] = -1;
+            }
+
+            c = 0;
+            mpoly_iter_init(iter, dP[var]);
+            while ((mt = mpoly_iter_next(iter)))
+            {
+                long v;
+
+                mon_mul(m, mt->key, cols[j]);
+                for (v = 0; v <= n; v++)
+                    if (mon_get_exp(m, v) >= d - 1)
+                        break;
+                if (v == n + 1)
+                    c++;
+            }
+            mpoly_iter_clear(iter);
+
+            L->mulp[j + 1] = c;
+        }
+    }
+
+    L->mulp[0] = 0;
+    for (j = 0; j < L->ncols; j++)
+        L->mulp[j + 1] += L->mulp[j];
+
+    /* Multiplication operator */
+    c = L->mulp[L->ncols];
+    L->muli = malloc(c * sizeof(long));
+    L->mulx = (c > 0) ? _vec_init(c, ctx) : NULL;
+
+    for (var = 0; var <= n; var++)
+    {
+        for (j = p[var]; j < p[var + 1]; j++)
+        {
+            mpoly_iter_t iter;
+            mpoly_term mt;
+            mon_t m;
+
+            c = L->mulp[j];
+            mpoly_iter_init(iter, dP[var]);
+            while ((mt = mpoly_iter_next(iter)))
+            {
+                long i;
+
+                mon_mul(m, mt->key, cols[j]);
+                i = _gmc_level_basis_index(L, gmc_level_rank(L, m));
+                if (i >= 0)
+                {
+                    L->muli[c] = i;
+                    ctx->set(ctx, L->mulx + c * ctx->size, mt->val);
+                    c++;
+                }
+            }
+            mpoly_iter_clear(iter);
+        }
+    }
+}
+
@@ -6,6 +6,19 @@
 
 #include "gmconnection.h" 
 
+/* Ensures that the scratch space W has length at least len */
+static char * _gmc_reduce_fit(char *W, long *lenW, long len, const ctx_t ctx)
+{
+    if (len > *lenW)
+    {
+        if (*lenW > 0)
+            _vec_clear(W, *lenW, ctx);
+        W = _vec_init(len, ctx);
+        *lenW = len;
+    }
+    return W;
+}
+
 void gmc_reduce(mpoly_t *R, 
                 const mpoly_t Q0, long k, long d, mpoly_t *dP, 
                 mat_csr_solve_t *s, 
@@ -18,6 +31,8 @@ void gmc_reduce(mpoly_t *R,
     mpoly_t *A;
     mpoly_t dAdX;
     mpoly_t Q;
+    char *W = NULL;
+    long lenW = 0;
 
     /* Init */
     n = Q0->n;
@@ -34,7 +49,8 @@ void gmc_reduce(mpoly_t *R,
      */
     if (k == u + 1)
     {
-        gmc_decompose_poly(A, Q, s[k], rows[k], cols[k], p[k], ctx);
+        W = _gmc_reduce_fit(W, &lenW, _gmc_decompose_poly_worklen(s[k]), ctx);
+        _gmc_decompose_poly(A, Q, s[k], rows[k], cols[k], p[k], W, ctx);
         
         /* Set up the next polynomial to be decomposed */
         mpoly_zero(Q, ctx);
@@ -53,7 +69,8 @@ void gmc_reduce(mpoly_t *R,
     
     while (!gmc_basis_contains(Q, d))
     {
-        gmc_decompose_poly(A, Q, s[k], rows[k], cols[k], p[k], ctx);
+        W = _gmc_reduce_fit(W, &lenW, _gmc_decompose_poly_worklen(s[k]), ctx);
+        _gmc_decompose_poly(A, Q, s[k], rows[k], cols[k], p[k], W, ctx);
         
         for (i = 0; i < n; i++)
             mpoly_submul(Q, A[i], dP[i], ctx);
@@ -85,5 +102,7 @@ void gmc_reduce(mpoly_t *R,
     free(A);
     mpoly_clear(dAdX, ctx);
     mpoly_clear(Q, ctx);
+    if (lenW > 0)
+        _vec_clear(W, lenW, ctx);
 }
 
@@ -0,0 +1,190 @@
+/******************************************************************************
+
+    Copyright (C) 2013 Sebastian Pancratz
+ 
+******************************************************************************/
+
+#include "gmconnection.h" 
+
+/*
+    Returns whether the r vectors at level L, given as the columns of 
+    the array Q in row-major order, only have non-zero entries in 
+    positions corresponding to basis monomials.
+ */
+static int _gmc_level_in_basis(const char *Q, long r, const gmc_level_t L, 
+                               const ctx_t ctx)
+{
+    long i, c;
+
+    for (i = 0; i < L->lenN; i++)
+        for (c = 0; c < r; c++)
+            if (!ctx->is_zero(ctx, Q + (L->N[i] * r + c) * ctx->size))
+                return 0;
+    return 1;
+}
+
+/*
+    Returns the lengths of the scratch vectors x and b for the solves 
+    at the levels 1, ..., k.
+ */
+static void _gmc_reduce_dense_lens(long *lenx, long *lenb, 
+                                   gmc_level_t *L, long k)
+{
+    long i;
+
+    *lenx = 1;
+    *lenb = 1;
+    for (i = 1; i <= k; i++)
+    {
+        *lenx = FLINT_MAX(*lenx, L[i]->ncols);
+        *lenb = FLINT_MAX(*lenb, L[i]->lenN);
+    }
+}
+
+long _gmc_reduce_dense_mat_worklen(gmc_level_t *L, long k, long r)
+{
+    long lenx, lenb;
+
+    _gmc_reduce_dense_lens(&lenx, &lenb, L, k);
+
+    /* The last part bounds the workspace of any solve of size at most lenx */
+    return (2 * L[k]->len + lenx + lenb) * r + 1 + (6 * lenx * r + 2 * lenx + 4);
+}
+
+long _gmc_reduce_dense_worklen(gmc_level_t *L, long k)
+{
+    return _gmc_reduce_dense_mat_worklen(L, k, 1);
+}
+
+void _gmc_reduce_dense_mat(char **R, const char *Q0, long r, long k, 
+                           gmc_level_t *L, mat_csr_solve_t *s, 
+                           long l, long u, char *W, const ctx_t ctx)
+{
+    const long len = L[k]->len;
+    const long w = r * ctx->size;   /* Width of a row in bytes */
+
+    long c, i, j, q, lenx, lenb;
+    char *Q, *Q1, *x, *b, *t, *Ws;
+
+    _gmc_reduce_dense_lens(&lenx, &lenb, L, k);
+
+    Q  = W;
+    Q1 = Q  + len * w;
+    x  = Q1 + len * w;
+    b  = x  + lenx * w;
+    t  = b  + lenb * w;
+    Ws = t  + ctx->size;
+
+    _vec_set(Q, Q0, len * r, ctx);
+
+    /* Ensure that all higher parts of the reduction array are zero */
+    for (i = FLINT_MAX(k + 1, l); i <= u; i++)
+        if (L[i]->lenB > 0)
+            _vec_zero(R[i], L[i]->lenB * r, ctx);
+
+    /*
+        Note that the basis at level u + 1 is empty, so that the first 
+        step is always taken in that case.  Columns which already lie 
+        in the basis have zero right-hand sides, and thus contribute 
+        nothing further to the lower levels.
+     */
+    while (!_gmc_level_in_basis(Q, r, L[k], ctx))
+    {
+        const __gmc_level_struct *Lk = L[k];
+        const __gmc_level_struct *L1 = L[k - 1];
+
+        /* Decompose Q = \sum_{var} A_{var} dP_{var} on the non-basis part */
+        for (i = 0; i < Lk->lenN; i++)
+            _vec_set(b + i * w, Q + Lk->N[i] * w, r, ctx);
+        _mat_csr_solve_mat(x, s[k], b, r, Ws, ctx);
+
+        /* R[k] := Q - \sum_{var} A_{var} dP_{var}, on the basis part */
+        if (k <= u)
+        {
+            for (i = 0; i < Lk->lenB; i++)
+                _vec_set(R[k] + i * w, Q + Lk->B[i] * w, r, ctx);
+
+            for (j = 0; j < Lk->ncols; j++)
+                for (c = 0; c < r; c++)
+                {
+                    const char *y = x + j * w + c * ctx->size;
+
+                    if (ctx->is_zero(ctx, y))
+                        continue;
+                    for (q = Lk->mulp[j]; q < Lk->mulp[j + 1]; q++)
+                    {
+                        char *e = R[k] + Lk->muli[q] * w + c * ctx->size;
+
+                        ctx->mul(ctx, t, y, Lk->mulx + q * ctx->size);
+                        ctx->sub(ctx, e, e, t);
+                    }
+                }
+        }
+
+        /* Q := \sum_{var} d/dX_{var} A_{var} / (k - 1) */
+        if (L1->len > 0)
+        {
+            _vec_zero(Q1, L1->len * r, ctx);
+
+            for (j = 0; j < Lk->ncols; j++)
+            {
+                if (Lk->dpos[j] < 0)
+                    continue;
+
+                for (c = 0; c < r; c++)
+                {
+                    const char *y = x + j * w + c * ctx->size;
+                    char *e = Q1 + Lk->dpos[j] * w + c * ctx->size;
+
+                    if (ctx->is_zero(ctx, y))
+                        continue;
+
+                    ctx->set_si(ctx, t, Lk->dexp[j]);
+                    ctx->mul(ctx, t, t, y);
+                    ctx->add(ctx, e, e, t);
+                }
+            }
+
+            ctx->set_si(ctx, t, k - 1);
+            for (i = 0; i < L1->len * r; i++)
+                ctx->div(ctx, Q1 + i * ctx->size, Q1 + i * ctx->size, t);
+        }
+
+        k--;
+        {
+            char *T = Q; Q = Q1; Q1 = T;
+        }
+    }
+
+    /* Set the last elements Q, which we know lie in the basis */
+    if (l <= k && k <= u)
+    {
+        for (i = 0; i < L[k]->lenB; i++)
+            _vec_set(R[k] + i * w, Q + L[k]->B[i] * w, r, ctx);
+    }
+
+    for (k = FLINT_MIN(k, u + 1) - 1; k >= l; k--)
+        if (L[k]->lenB > 0)
+            _vec_zero(R[k], L[k]->lenB * r, ctx);
+}
+
+void _gmc_reduce_dense(char **R, const char *Q0, long k, 
+                       gmc_level_t *L, mat_csr_solve_t *s, 
+                       long l, long u, char *W, const ctx_t ctx)
+{
+    _gmc_reduce_dense_mat(R, Q0, 1, k, L, s, l, u, W, ctx);
+}
+
+void gmc_reduce_dense(char **R, const char *Q0, long k, 
+                      gmc_level_t *L, mat_csr_solve_t *s, 
+                      long l, long u, const ctx_t ctx)
+{
+    const long lenW = _gmc_reduce_dense_worklen(L, k);
+
+    char *W;
+
+    W = _vec_init(lenW, ctx);
+    _gmc_reduce_dense(R, Q0, k, L, s, l, u, W, ctx);
+    _vec_clear(W, lenW, ctx);
+}
+
@@ -0,0 +1,75 @@
+/******************************************************************************
+
+    Copyright (C) 2013 Sebastian Pancratz
+ 
+******************************************************************************/
+
+#include "gmconnection.h"
+
+void _gmc_symbolic_clear_memo(gmc_symbolic_t S, const ctx_t ctx)
+{
+    long k;
+
+    if (!S->slot)
+        return;
+
+    for (k = 0; k <= S->u + 1; k++)
+        free(S->slot[k]);
+    free(S->slot);
+    free(S->imgk);
+    free(S->imgr);
+    free(S->T);
+    if (S->nimg > 0)
+        _vec_clear(S->img, S->nimg * S->lenB, ctx);
+
+    S->slot = NULL;
+}
+
+void gmc_symbolic_clear(gmc_symbolic_t S, const ctx_t ctx)
+{
+    long k;
+
+    if (!S->built)
+        return;
+
+    _gmc_symbolic_clear_memo(S, ctx);
+
+    if (S->vals)
+    {
+        _vec_clear(S->vals, FLINT_MAX(S->lenD, 1), ctx);
+        S->vals = NULL;
+    }
+
+    for (k = S->k0; k <= S->u + 1; k++)
+    {
+        free(S->aux_rows[k]);
+        free(S->aux_cols[k]);
+        free(S->aux_p[k]);
+        free(S->auxsrc[k]);
+        mat_csr_clear(S->aux[k], ctx);
+        mat_csr_solve_clear(S->aux_s[k], ctx);
+    }
+
+    free(S->aux);
+    free(S->auxsrc);
+    free(S->aux_rows);
+    free(S->aux_cols);
+    free(S->aux_p);
+    free(S->aux_s);
+
+    for (k = 0; k <= S->u + 1; k++)
+    {
+        gmc_level_clear(S->L[k], ctx);
+        free(S->mulsrc[k]);
+    }
+    free(S->L);
+    free(S->mulsrc);
+
+    free(S->B);
+    free(S->iB);
+    free(S->D);
+    free(S->iD);
+
+    S->built = 0;
+}
+
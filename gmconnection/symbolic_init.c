@@ -0,0 +1,16 @@
+/******************************************************************************
+
+    Copyright (C) 2013 Sebastian Pancratz
+ 
+******************************************************************************/
+
+#include "gmconnection.h"
+
+void gmc_symbolic_init(gmc_symbolic_t S)
+{
+    S->built = 0;
+    S->vals  = NULL;
+    S->slot  = NULL;
+    S->time  = NULL;
+}
+
@@ -0,0 +1,272 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gmp.h>
+
+#include "flint/flint.h"
+#include "flint/fmpz.h"
+#include "flint/ulong_extras.h"
+
+#include "mpoly.h"
+#include "mat_csr.h"
+#include "gmconnection.h"
+
+int
+main(void)
+{
+    int i, result;
+    flint_rand_t state;
+    ctx_t ctx;
+    const char *dir;
+
+    printf("cache... ");
+    fflush(stdout);
+
+    _randinit(state);
+
+    ctx_init_fmpz_poly_q(ctx);
+
+    dir = getenv("TMPDIR");
+    if (dir == NULL)
+        dir = "/tmp";
+
+    /* Check that storing and loading round-trips */
+    for (i = 0; i < 2; i++)
+    {
+        const char *str[2] = {
+            "3  [3 0 0] [0 3 0] [0 0 3] (2  0 1)[1 1 1]", 
+            "3  [3 0 0] [0 3 0] [0 0 3] (2  0 2)[1 1 1]"
+        };
+
+        mpoly_t P;
+        long b, n, j;
+        char *key, *path;
+
+        mat_t M1, M2;
+        mon_t *rows1, *cols1, *rows2, *cols2;
+
+        n = atoi(str[i]) - 1;
+        mpoly_init(P, n + 1, ctx);
+        mpoly_set_str(P, str[i], ctx);
+
+        b = gmc_basis_size(n, mpoly_degree(P, -1, ctx));
+        mat_init(M1, b, b, ctx);
+        mat_init(M2, b, b, ctx);
+
+        gmc_compute(M1, &rows1, &cols1, P, ctx);
+        gmc_cache_store(M1, rows1, NULL, P, dir, ctx);
+
+        result = gmc_cache_load(M2, &rows2, &cols2, NULL, P, dir, ctx);
+        for (j = 0; result && j < b; j++)
+            result = (rows1[j] == rows2[j]) && (cols1[j] == cols2[j]);
+        result = result && mat_equal(M1, M2, ctx);
+        if (!result)
+        {
+            printf("FAIL:\n\n");
+            printf("P  = "), mpoly_print(P, ctx), printf("\n");
+            printf("M1 = \n"), mat_print(M1, ctx), printf("\n");
+            printf("M2 = \n"), mat_print(M2, ctx), printf("\n");
+            abort();
+        }
+
+        key  = gmc_cache_key(P, ctx);
+        path = _gmc_cache_path(dir, key, "");
+        remove(path);
+        free(key);
+        free(path);
+
+        mat_clear(M1, ctx);
+        mat_clear(M2, ctx);
+        free(rows1);
+        free(cols1);
+        free(rows2);
+        free(cols2);
+        mpoly_clear(P, ctx);
+    }
+
+    /* Check that rational multiples of P share the cache entry */
+    {
+        const char *str = "3  [3 0 0] [0 3 0] [0 0 3] (2  0 1)[1 1 1]";
+
+        mpoly_t P, Q;
+        long b, n, j;
+        char *key1, *key2, *path;
+
+        mat_t M1, M2;
+        mon_t *rows1, *cols1, *rows2, *cols2;
+
+        n = atoi(str) - 1;
+        mpoly_init(P, n + 1, ctx);
+        mpoly_init(Q, n + 1, ctx);
+        mpoly_set_str(P, str, ctx);
+        mpoly_scalar_mul_si(Q, P, -6, ctx);
+
+        key1 = gmc_cache_key(P, ctx);
+        key2 = gmc_cache_key(Q, ctx);
+        result = !strcmp(key1, key2);
+        if (!result)
+        {
+            printf("FAIL (key):\n\n");
+            printf("P = "), mpoly_print(P, ctx), printf("\n");
+            printf("Q = "), mpoly_print(Q, ctx), printf("\n");
+            printf("key(P) = %s\n", key1);
+            printf("key(Q) = %s\n", key2);
+            abort();
+        }
+
+        b = gmc_basis_size(n, mpoly_degree(P, -1, ctx));
+        mat_init(M1, b, b, ctx);
+        mat_init(M2, b, b, ctx);
+
+        gmc_compute(M1, &rows1, &cols1, P, ctx);
+        gmc_cache_store(M1, rows1, NULL, P, dir, ctx);
+        mat_zero(M1, ctx);
+        free(rows1);
+        free(cols1);
+
+        gmc_compute(M1, &rows1, &cols1, Q, ctx);
+        result = gmc_cache_load(M2, &rows2, &cols2, NULL, Q, dir, ctx);
+        for (j = 0; result && j < b; j++)
+            result = (rows1[j] == rows2[j]) && (cols1[j] == cols2[j]);
+        result = result && mat_equal(M1, M2, ctx);
+        if (!result)
+        {
+            printf("FAIL (multiple):\n\n");
+            printf("Q  = "), mpoly_print(Q, ctx), printf("\n");
+            printf("M1 = \n"), mat_print(M1, ctx), printf("\n");
+            printf("M2 = \n"), mat_print(M2, ctx), printf("\n");
+            abort();
+        }
+
+        path = _gmc_cache_path(dir, key1, "");
+        remove(path);
+        free(key1);
+        free(key2);
+        free(path);
+
+        mat_clear(M1, ctx);
+        mat_clear(M2, ctx);
+        free(rows1);
+        free(cols1);
+        free(rows2);
+        free(cols2);
+        mpoly_clear(P, ctx);
+        mpoly_clear(Q, ctx);
+    }
+
+    /* Check that truncated and corrupted files are rejected */
+    {
+        const char *str = "3  [3 0 0] [0 3 0] [0 0 3] (2  0 1)[1 1 1]";
+
+        mpoly_t P;
+        long b, n, len, k, lenr, offr, offM, v = 0;
+        char *key, *path, *data;
+        FILE *f;
+
+        mat_t M;
+        mon_t *rows, *cols;
+
+        n = atoi(str) - 1;
+        mpoly_init(P, n + 1, ctx);
+        mpoly_set_str(P, str, ctx);
+
+        b = gmc_basis_size(n, mpoly_degree(P, -1, ctx));
+        mat_init(M, b, b, ctx);
+
+        gmc_compute(M, &rows, &cols, P, ctx);
+        gmc_cache_store(M, rows, NULL, P, dir, ctx);
+        free(rows);
+        free(cols);
+
+        key  = gmc_cache_key(P, ctx);
+        path = _gmc_cache_path(dir, key, "");
+
+        f = fopen(path, "rb");
+        fseek(f, 0, SEEK_END);
+        len = ftell(f);
+        rewind(f);
+        data = malloc(len);
+        result = (fread(data, 1, len, f) == (size_t) len);
+        fclose(f);
+
+        /* 
+            Offsets of the length of the denominator r and of the length 
+            of the numerator of the first entry of M, skipping over the 
+            coefficients of r as written by fmpz_out_raw(), each a 
+            four-byte big-endian size followed by that many bytes
+         */
+        offr = 4 + sizeof(long) + strlen(key) + sizeof(long) + b * sizeof(mon_t);
+        memcpy(&lenr, data + offr, sizeof(long));
+        offM = offr + sizeof(long);
+        for (i = 0; i < lenr; i++)
+        {
+            const unsigned char *u = (const unsigned char *) data + offM;
+            long size = ((long) u[0] << 24) | (u[1] << 16) | (u[2] << 8) | u[3];
+
+            if (size >= (1L << 31))
+                size = (1L << 32) - size;
+            offM += 4 + size;
+        }
+
+        /* 
+            Truncations to k bytes, then a corrupt magic and key, and 
+            corrupt lengths of r and of the first entry of M
+         */
+        for (k = 0; result && k <= len + 3; k++)
+        {
+            long m = k, w = LONG_MAX;
+
+            if (k == len)
+                data[1] ^= 0x55;
+            if (k == len + 1)
+            {
+                data[1] ^= 0x55;
+                data[4 + sizeof(long)] ^= 0x55;
+            }
+            if (k == len + 2)
+            {
+                data[4 + sizeof(long)] ^= 0x55;
+                memcpy(&v, data + offr, sizeof(long));
+                memcpy(data + offr, &w, sizeof(long));
+            }
+            if (k == len + 3)
+            {
+                memcpy(data + offr, &v, sizeof(long));
+                memcpy(&v, data + offM, sizeof(long));
+                memcpy(data + offM, &w, sizeof(long));
+            }
+            if (k >= len)
+                m = len;
+
+            f = fopen(path, "wb");
+            fwrite(data, 1, m, f);
+            fclose(f);
+
+            mat_one(M, ctx);
+            result = !gmc_cache_load(M, &rows, &cols, NULL, P, dir, ctx)
+                  && mat_is_zero(M, ctx);
+            if (!result)
+            {
+                printf("FAIL (corrupt):\n\n");
+                printf("len = %ld, k = %ld\n", len, k);
+                abort();
+            }
+        }
+
+        remove(path);
+        free(data);
+        free(key);
+        free(path);
+
+        mat_clear(M, ctx);
+        mpoly_clear(P, ctx);
+    }
+
+    ctx_clear(ctx);
+
+    _randclear(state);
+    _fmpz_cleanup();
+    printf("PASS\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,116 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <gmp.h>
+
+#include "flint/flint.h"
+#include "flint/fmpz.h"
+#include "flint/ulong_extras.h"
+
+#include "mpoly.h"
+#include "mat_csr.h"
+#include "gmconnection.h"
+
+int
+main(void)
+{
+    int i, result;
+    flint_rand_t state;
+    ctx_t ctx;
+
+    printf("character_blocks... ");
+    fflush(stdout);
+
+    _randinit(state);
+
+    ctx_init_fmpz_poly_q(ctx);
+
+    /*
+        Diagonal pencils P = \sum X_i^d + t X^e, for which the lattice of 
+        characters is generated by d Z^{n+1} and e, so that two basis 
+        monomials X^a and X^b lie in the same block if and only if 
+        a - b = c e modulo d for some c.  Check the number of blocks, 
+        that the labels agree with these classes, and that M vanishes 
+        between different blocks.
+     */
+    for (i = 0; i < 4; i++)
+    {
+        const char *str[4] = {
+            "4  [4 0 0 0] [0 4 0 0] [0 0 4 0] [0 0 0 4] (2  0 1)[1 1 1 1]", 
+            "3  [4 0 0] [0 4 0] [0 0 4] (2  0 1)[2 2 0]", 
+            "3  [5 0 0] [0 5 0] [0 0 5] (2  0 1)[1 1 3]", 
+            "3  [3 0 0] [0 3 0] [0 0 3] (2  0 1)[2 1 0]"
+        };
+        const long e[4][4] = {{1, 1, 1, 1}, {2, 2, 0}, {1, 1, 3}, {2, 1, 0}};
+        const long nbs[4] = {16, 5, 5, 2};
+
+        mpoly_t P;
+        long b, c, d, j, k, v, n, nb, *blk;
+
+        mat_t M;
+        mon_t *rows, *cols;
+
+        n = atoi(str[i]) - 1;
+        mpoly_init(P, n + 1, ctx);
+        mpoly_set_str(P, str[i], ctx);
+        d = mpoly_degree(P, -1, ctx);
+
+        b = gmc_basis_size(n, d);
+        mat_init(M, b, b, ctx);
+        blk = malloc(b * sizeof(long));
+
+        gmc_compute(M, &rows, &cols, P, ctx);
+        nb = gmc_character_blocks(blk, rows, b, P, ctx);
+
+        result = (nb == nbs[i]);
+        for (j = 0; j < b; j++)
+        {
+            result = result && (0 <= blk[j] && blk[j] < nb);
+            for (k = 0; k < b; k++)
+            {
+                int same = 0;
+
+                for (c = 0; c < d && !same; c++)
+                {
+                    same = 1;
+                    for (v = 0; v <= n; v++)
+                    {
+                        const long x = mon_get_exp(rows[j], v);
+                        const long y = mon_get_exp(rows[k], v);
+
+                        if ((x - y - c * e[i][v]) % d != 0)
+                            same = 0;
+                    }
+                }
+
+                result = result && (same == (blk[j] == blk[k]));
+                if (blk[j] != blk[k])
+                    result = result && ctx->is_zero(ctx, mat_entry(M, j, k, ctx));
+            }
+        }
+        if (!result)
+        {
+            printf("FAIL:\n\n");
+            printf("P  = "), mpoly_print(P, ctx), printf("\n");
+            printf("M  = \n"), mat_print(M, ctx), printf("\n");
+            printf("nb = %ld, expected %ld\n", nb, nbs[i]);
+            printf("blk = {");
+            for (j = 0; j < b; j++)
+                printf("%ld%s", blk[j], (j + 1 < b) ? ", " : "}\n");
+            abort();
+        }
+
+        mat_clear(M, ctx);
+        free(rows);
+        free(cols);
+        free(blk);
+        mpoly_clear(P, ctx);
+    }
+
+    ctx_clear(ctx);
+
+    _randclear(state);
+    _fmpz_cleanup();
+    printf("PASS\n");
+    return EXIT_SUCCESS;
+}
+
@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <gmp.h>
+
+#include "flint/flint.h"
+#include "flint/fmpz.h"
+#include "flint/ulong_extras.h"
+
+#include "mpoly.h"
+#include "mat_csr.h"
+#include "gmconnection.h"
+
+int
+main(void)
+{
+    int result;
+    flint_rand_t state;
+    ctx_t ctx;
+
+    printf("compute... ");
+    fflush(stdout);
+
+    _randinit(state);
+
+    ctx_init_fmpz_poly_q(ctx);
+
+    /*
+        Compare the fraction-free computation against the one over Q(t),
+        for a sextic curve without diagonal symmetries, whose auxiliary
+        matrix at the top level has a diagonal block of length 85, so
+        that it goes through the sparse factorisation
+     */
+    {
+        const char *str =
+            "3  [6 0 0] [0 6 0] [0 0 6] (2  0 1)[5 1 0] (2  0 1)[0 5 1] (2  0 1)[1 0 5]";
+
+        mpoly_t P, dPdt;
+        long b, n, d, k, len;
+        mon_t *rows, *cols;
+        long *p;
+
+        mat_csr_t A;
+        mat_csr_solve_t S;
+        mat_t M1, M2;
+        mon_t *rows1, *cols1, *rows2, *cols2;
+
+        n = atoi(str) - 1;
+        mpoly_init(P, n + 1, ctx);
+        mpoly_set_str(P, str, ctx);
+        mpoly_init(dPdt, n + 1, ctx);
+        mpoly_tderivative(dPdt, P, ctx);
+
+        d = mpoly_degree(P, -1, ctx);
+        b = gmc_basis_size(n, d);
+
+        /* The largest diagonal block of the auxiliary matrix */
+        p = malloc((n + 2) * sizeof(long));
+        gmc_init_auxmatrix(A, &rows, &cols, p, P, ((n + 1) * (d - 1)) / d + 1, ctx);
+
+        result = !mat_csr_solve_init_ff(S, A, ctx);
+        for (len = 0, k = 0; result && k < S->nb; k++)
+            len = FLINT_MAX(len, S->B[k + 1] - S->B[k]);
+        result = result && (len >= MAT_CSR_LU_SPARSE_MIN);
+        if (!result)
+        {
+            printf("FAIL (block):\n\n");
+            printf("P = "), mpoly_print(P, ctx), printf("\n");
+            printf("Largest block of length %ld\n", len);
+            abort();
+        }
+
+        mat_csr_solve_clear(S, ctx);
+        mat_csr_clear(A, ctx);
+        free(rows);
+        free(cols);
+        free(p);
+
+        mat_init(M1, b, b, ctx);
+        mat_init(M2, b, b, ctx);
+
+        gmc_compute(M1, &rows1, &cols1, P, ctx);
+
+        result = !_gmc_compute(M2, &rows2, &cols2, P, dPdt, 0, ctx);
+        for (k = 0; result && k < b; k++)
+            result = (rows1[k] == rows2[k]) && (cols1[k] == cols2[k]);
+        result = result && mat_equal(M1, M2, ctx);
+        if (!result)
+        {
+            printf("FAIL:\n\n");
+            printf("P  = "), mpoly_print(P, ctx), printf("\n");
+            printf("M1 = \n"), mat_print(M1, ctx), printf("\n");
+            printf("M2 = \n"), mat_print(M2, ctx), printf("\n");
+            abort();
+        }
+
+        mat_clear(M1, ctx);
+        mat_clear(M2, ctx);
+        free(rows1);
+        free(cols1);
+        free(rows2);
+        free(cols2);
+        mpoly_clear(P, ctx);
+        mpoly_clear(dPdt, ctx);
+    }
+
+    ctx_clear(ctx);
+
+    _randclear(state);
+    _fmpz_cleanup();
+    printf("PASS\n");
+    return EXIT_SUCCESS;
+}
+
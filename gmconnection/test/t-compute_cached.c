@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <gmp.h>
+
+#include "flint/flint.h"
+#include "flint/fmpz.h"
+#include "flint/ulong_extras.h"
+
+#include "mpoly.h"
+#include "mat_csr.h"
+#include "gmconnection.h"
+
+int
+main(void)
+{
+    int i, result;
+    flint_rand_t state;
+    ctx_t ctx;
+    gmc_symbolic_t S;
+
+    printf("compute_cached... ");
+    fflush(stdout);
+
+    _randinit(state);
+
+    ctx_init_fmpz_poly_q(ctx);
+
+    gmc_symbolic_init(S);
+
+    /*
+        Compare against the direct computation over Q(t), for a sequence 
+        of polynomials where the first two and the last two have the same 
+        supports, so that the symbolic data is both reused and set up anew; 
+        each polynomial is computed twice, the second time reusing the 
+        factorisations and the memoised reductions
+     */
+    for (i = 0; i < 4; i++)
+    {
+        const char *str[4] = {
+            "3  [3 0 0] [0 3 0] [0 0 3] (2  0 1)[1 1 1]", 
+            "3  (1  2)[3 0 0] (1  -1)[0 3 0] [0 0 3] (2  1 3)[1 1 1]", 
+            "4  [4 0 0 0] [0 4 0 0] [0 0 4 0] [0 0 0 4] (2  0 1)[1 1 1 1]", 
+            "4  [4 0 0 0] (1  3)[0 4 0 0] [0 0 4 0] [0 0 0 4] (2  -1 2)[1 1 1 1]"
+        };
+
+        mpoly_t P;
+        long b, n;
+
+        mat_t M1, M2, M3;
+        mon_t *rows1, *cols1, *rows2, *cols2, *rows3, *cols3;
+
+        n = atoi(str[i]) - 1;
+        mpoly_init(P, n + 1, ctx);
+        mpoly_set_str(P, str[i], ctx);
+
+        b = gmc_basis_size(n, mpoly_degree(P, -1, ctx));
+        mat_init(M1, b, b, ctx);
+        mat_init(M2, b, b, ctx);
+        mat_init(M3, b, b, ctx);
+
+        gmc_compute(M1, &rows1, &cols1, P, ctx);
+        gmc_compute_cached(M2, &rows2, &cols2, P, S, ctx);
+        gmc_compute_cached(M3, &rows3, &cols3, P, S, ctx);
+
+        result = mat_equal(M1, M2, ctx) && mat_equal(M1, M3, ctx);
+        if (!result)
+        {
+            printf("FAIL:\n\n");
+            printf("P  = "), mpoly_print(P, ctx), printf("\n");
+            printf("M1 = \n"), mat_print(M1, ctx), printf("\n");
+            printf("M2 = \n"), mat_print(M2, ctx), printf("\n");
+            printf("M3 = \n"), mat_print(M3, ctx), printf("\n");
+            abort();
+        }
+
+        mat_clear(M1, ctx);
+        mat_clear(M2, ctx);
+        mat_clear(M3, ctx);
+        free(rows1);
+        free(cols1);
+        free(rows2);
+        free(cols2);
+        free(rows3);
+        free(cols3);
+        mpoly_clear(P, ctx);
+    }
+
+    gmc_symbolic_clear(S, ctx);
+
+    ctx_clear(ctx);
+
+    _randclear(state);
+    _fmpz_cleanup();
+    printf("PASS\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gmp.h>
+
+#include "flint/flint.h"
+#include "flint/fmpz.h"
+#include "flint/ulong_extras.h"
+
+#include "mpoly.h"
+#include "mat_csr.h"
+#include "gmconnection.h"
+
+int
+main(void)
+{
+    int i, result;
+    flint_rand_t state;
+    ctx_t ctx;
+
+    printf("compute_multimod... ");
+    fflush(stdout);
+
+    _randinit(state);
+
+    ctx_init_fmpz_poly_q(ctx);
+
+    /*
+        Compare against the direct computation over Q(t), for cubics 
+        with a coefficient divisible by the first primes tried, which 
+        are unlucky as the reduction of this coefficient vanishes.  The 
+        coefficient of X^3 is the product of the first i + 1 primes for 
+        i = 0, 1, and of the first eight primes for i = 2, so that with 
+        at most eight threads the whole first batch is discarded.
+     */
+    for (i = 0; i < 3; i++)
+    {
+        const long np = (i < 2) ? i + 1 : 8;
+
+        mp_limb_t ell;
+        fmpz_t c;
+        char *cstr, *str;
+        long j;
+
+        mpoly_t P;
+        long b, n;
+
+        mat_t M1, M2;
+        mon_t *rows1, *cols1, *rows2, *cols2;
+
+        fmpz_init(c);
+        fmpz_one(c);
+        ell = UWORD(1) << (FLINT_BITS - 2);
+        for (j = 0; j < np; j++)
+        {
+            ell = n_nextprime(ell, 1);
+            fmpz_mul_ui(c, c, ell);
+        }
+        cstr = fmpz_get_str(NULL, 10, c);
+        str  = malloc(strlen(cstr) + 64);
+        sprintf(str, "3  (1  %s)[3 0 0] [0 3 0] [0 0 3] (2  0 1)[1 1 1]", cstr);
+
+        n = 2;
+        mpoly_init(P, n + 1, ctx);
+        mpoly_set_str(P, str, ctx);
+
+        b = gmc_basis_size(n, mpoly_degree(P, -1, ctx));
+        mat_init(M1, b, b, ctx);
+        mat_init(M2, b, b, ctx);
+
+        gmc_compute(M1, &rows1, &cols1, P, ctx);
+        gmc_compute_multimod(M2, &rows2, &cols2, P, ctx);
+
+        result = mat_equal(M1, M2, ctx);
+        if (!result)
+        {
+            printf("FAIL:\n\n");
+            printf("P  = "), mpoly_print(P, ctx), printf("\n");
+            printf("M1 = \n"), mat_print(M1, ctx), printf("\n");
+            printf("M2 = \n"), mat_print(M2, ctx), printf("\n");
+            abort();
+        }
+
+        mat_clear(M1, ctx);
+        mat_clear(M2, ctx);
+        free(rows1);
+        free(cols1);
+        free(rows2);
+        free(cols2);
+        mpoly_clear(P, ctx);
+        flint_free(cstr);
+        free(str);
+        fmpz_clear(c);
+    }
+
+    ctx_clear(ctx);
+
+    _randclear(state);
+    _fmpz_cleanup();
+    printf("PASS\n");
+    return EXIT_SUCCESS;
+}
+
@@ -0,0 +1,86 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <gmp.h>
+
+#include "flint/flint.h"
+#include "flint/fmpz.h"
+#include "flint/ulong_extras.h"
+
+#include "mpoly.h"
+#include "mat_csr.h"
+#include "gmconnection.h"
+
+int
+main(void)
+{
+    int i, result;
+    flint_rand_t state;
+    ctx_t ctx;
+
+    printf("compute_pencil... ");
+    fflush(stdout);
+
+    _randinit(state);
+
+    ctx_init_fmpz_poly_q(ctx);
+
+    /*
+        Compare against the direct computation over Q(t), for pencils 
+        which cannot be expanded around t = 0:  the first is singular 
+        at t = 0, as X^3 + Y^3 + Z^3 - 3 XYZ is a product of linear 
+        forms, and in the second the coefficients of the Fermat terms 
+        vanish at t = 0.  The third can, and is a non-diagonal 
+        deformation of the Fermat quartic.
+     */
+    for (i = 0; i < 3; i++)
+    {
+        const char *str[3] = {
+            "3  [3 0 0] [0 3 0] [0 0 3] (2  -3 1)[1 1 1]", 
+            "3  (2  0 1)[3 0 0] (2  0 1)[0 3 0] (2  0 1)[0 0 3] [1 1 1]", 
+            "3  [4 0 0] [0 4 0] [0 0 4] (2  0 1)[2 2 0]"
+        };
+
+        mpoly_t P;
+        long b, n;
+
+        mat_t M1, M2;
+        mon_t *rows1, *cols1, *rows2, *cols2;
+
+        n = atoi(str[i]) - 1;
+        mpoly_init(P, n + 1, ctx);
+        mpoly_set_str(P, str[i], ctx);
+
+        b = gmc_basis_size(n, mpoly_degree(P, -1, ctx));
+        mat_init(M1, b, b, ctx);
+        mat_init(M2, b, b, ctx);
+
+        gmc_compute(M1, &rows1, &cols1, P, ctx);
+        gmc_compute_pencil(M2, &rows2, &cols2, P, ctx);
+
+        result = mat_equal(M1, M2, ctx);
+        if (!result)
+        {
+            printf("FAIL:\n\n");
+            printf("P  = "), mpoly_print(P, ctx), printf("\n");
+            printf("M1 = \n"), mat_print(M1, ctx), printf("\n");
+            printf("M2 = \n"), mat_print(M2, ctx), printf("\n");
+            abort();
+        }
+
+        mat_clear(M1, ctx);
+        mat_clear(M2, ctx);
+        free(rows1);
+        free(cols1);
+        free(rows2);
+        free(cols2);
+        mpoly_clear(P, ctx);
+    }
+
+    ctx_clear(ctx);
+
+    _randclear(state);
+    _fmpz_cleanup();
+    printf("PASS\n");
+    return EXIT_SUCCESS;
+}
+
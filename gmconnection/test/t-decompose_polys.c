@@ -0,0 +1,138 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <gmp.h>
+
+#include "flint/flint.h"
+#include "flint/fmpz.h"
+#include "flint/ulong_extras.h"
+
+#include "mpoly.h"
+#include "mat_csr.h"
+#include "gmconnection.h"
+
+#define RUNS 50
+
+int
+main(void)
+{
+    int i, result;
+    flint_rand_t state;
+    ctx_t ctx;
+
+    printf("decompose_polys... ");
+    fflush(stdout);
+
+    _randinit(state);
+
+    ctx_init_mpq(ctx);
+
+    /* Compare against repeated calls to gmc_decompose_poly() */
+    {
+        mpoly_t P;
+
+        mon_t *B;
+        long *iB, lenB, l, u, k, k0;
+        long n, d;
+
+        mpoly_init(P, 4, ctx);
+        mpoly_set_str(P, "4  [4 0 0 0] [0 4 0 0] [0 0 4 0] [0 0 0 4] (3)[1 1 1 1]", ctx);
+
+        n = P->n - 1;
+        d = mpoly_degree(P, -1, ctx);
+        k0 = (n + (d - 1)) / d + 1;
+
+        gmc_basis_sets(&B, &iB, &lenB, &l, &u, n, d);
+
+        for (k = k0; k <= u + 1; k++)
+        {
+            mat_csr_t mat;
+            mat_csr_solve_t s;
+            mon_t *rows, *cols;
+            long *p;
+
+            p = malloc((n + 2) * sizeof(long));
+            gmc_init_auxmatrix(mat, &rows, &cols, p, P, k, ctx);
+            mat_csr_solve_init(s, mat, ctx);
+
+            for (i = 0; i < RUNS; i++)
+            {
+                const long r = n_randint(state, 6) + 1;
+
+                mpoly_t *polys, **A1, *A2;
+                long c, var;
+
+                polys = malloc(r * sizeof(mpoly_t));
+                A1    = malloc(r * sizeof(mpoly_t *));
+                A2    = malloc((n + 1) * sizeof(mpoly_t));
+
+                for (c = 0; c < r; c++)
+                {
+                    mpoly_init(polys[c], n + 1, ctx);
+                    mpoly_randtest_hom(polys[c], state, k * d - (n + 1), 20, ctx);
+
+                    A1[c] = malloc((n + 1) * sizeof(mpoly_t));
+                    for (var = 0; var <= n; var++)
+                        mpoly_init(A1[c][var], n + 1, ctx);
+                }
+                for (var = 0; var <= n; var++)
+                    mpoly_init(A2[var], n + 1, ctx);
+
+                gmc_decompose_polys(A1, polys, r, s, rows, cols, p, ctx);
+
+                result = 1;
+                for (c = 0; c < r && result; c++)
+                {
+                    gmc_decompose_poly(A2, polys[c], s, rows, cols, p, ctx);
+
+                    for (var = 0; var <= n; var++)
+                        result &= mpoly_equal(A1[c][var], A2[var], ctx);
+                }
+
+                if (!result)
+                {
+                    c--;
+                    printf("FAIL:\n\n");
+                    printf("k = %ld, r = %ld, c = %ld\n", k, r, c);
+                    printf("poly = "), mpoly_print(polys[c], ctx), printf("\n");
+                    for (var = 0; var <= n; var++)
+                    {
+                        printf("A1[%ld] = ", var), mpoly_print(A1[c][var], ctx), printf("\n");
+                        printf("A2[%ld] = ", var), mpoly_print(A2[var], ctx), printf("\n");
+                    }
+                    abort();
+                }
+
+                for (c = 0; c < r; c++)
+                {
+                    mpoly_clear(polys[c], ctx);
+                    for (var = 0; var <= n; var++)
+                        mpoly_clear(A1[c][var], ctx);
+                    free(A1[c]);
+                }
+                for (var = 0; var <= n; var++)
+                    mpoly_clear(A2[var], ctx);
+                free(polys);
+                free(A1);
+                free(A2);
+            }
+
+            mat_csr_clear(mat, ctx);
+            mat_csr_solve_clear(s, ctx);
+            free(rows);
+            free(cols);
+            free(p);
+        }
+
+        mpoly_clear(P, ctx);
+        free(B);
+        free(iB);
+    }
+
+    ctx_clear(ctx);
+
+    _randclear(state);
+    _fmpz_cleanup();
+    printf("PASS\n");
+    return EXIT_SUCCESS;
+}
+
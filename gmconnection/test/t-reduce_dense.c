@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <gmp.h>
+
+#include "flint/flint.h"
+#include "flint/fmpz.h"
+#include "flint/ulong_extras.h"
+
+#include "mpoly.h"
+#include "mat_csr.h"
+#include "gmconnection.h"
+
+#define RUNS 100
+
+int
+main(void)
+{
+    int i, result;
+    flint_rand_t state;
+    ctx_t ctx;
+
+    printf("reduce_dense... ");
+    fflush(stdout);
+
+    _randinit(state);
+
+    ctx_init_mpq(ctx);
+
+    /* Compare against the reduction based on sparse polynomials */
+    {
+        mpoly_t P, *dP, Q, *Rm;
+
+        mon_t *B;
+        long *iB, lenB, l, u, k, k0, j;
+        long n, d;
+
+        mat_csr_t *aux;
+        mat_csr_solve_t *s;
+        mon_t **rows, **cols;
+        long **p;
+        gmc_level_t *L;
+        char **Rd, *v;
+
+        mpoly_init(P, 4, ctx);
+        mpoly_set_str(P, "4  [4 0 0 0] [0 4 0 0] [0 0 4 0] [0 0 0 4] (3)[1 1 1 1]", ctx);
+
+        n = P->n - 1;
+        d = mpoly_degree(P, -1, ctx);
+        k0 = (n + (d - 1)) / d + 1;
+
+        gmc_basis_sets(&B, &iB, &lenB, &l, &u, n, d);
+
+        dP = malloc((n + 1) * sizeof(mpoly_t));
+        for (j = 0; j <= n; j++)
+            mpoly_init(dP[j], n + 1, ctx);
+        gmc_derivatives(dP, P, ctx);
+
+        aux  = malloc((n + 2) * sizeof(mat_csr_t));
+        s    = malloc((n + 2) * sizeof(mat_csr_solve_t));
+        rows = malloc((n + 2) * sizeof(mon_t *));
+        cols = malloc((n + 2) * sizeof(mon_t *));
+        p    = malloc((n + 2) * sizeof(long *));
+        L    = malloc((u + 2) * sizeof(gmc_level_t));
+
+        for (k = 0; k <= u + 1; k++)
+            gmc_level_init(L[k], n, d, k);
+
+        for (k = k0; k <= u + 1; k++)
+        {
+            p[k] = malloc((n + 2) * sizeof(long));
+            gmc_init_auxmatrix(aux[k], rows + k, cols + k, p[k], P, k, ctx);
+            mat_csr_solve_init(s[k], aux[k], ctx);
+            gmc_level_set_ops(L[k], L[k - 1], dP, cols[k], p[k], ctx);
+        }
+
+        Rm = malloc((n + 2) * sizeof(mpoly_t));
+        for (k = 0; k <= n + 1; k++)
+            mpoly_init(Rm[k], n + 1, ctx);
+        Rd = malloc((u + 1) * sizeof(char *));
+        for (k = l; k <= u; k++)
+            Rd[k] = _vec_init(iB[k + 1] - iB[k], ctx);
+        v = _vec_init(lenB, ctx);
+
+        mpoly_init(Q, n + 1, ctx);
+
+        for (i = 0; i < RUNS; i++)
+        {
+            char *q;
+
+            k = k0 + n_randint(state, u + 2 - k0);
+
+            mpoly_randtest_hom(Q, state, k * d - (n + 1), 20, ctx);
+
+            q = _vec_init(L[k]->len, ctx);
+            gmc_poly2array(q, Q, L[k]->mon, L[k]->len, ctx);
+
+            gmc_reduce(Rm, Q, k, d, dP, s, rows, cols, p, l, u, ctx);
+            gmc_reduce_dense(Rd, q, k, L, s, l, u, ctx);
+
+            result = 1;
+            for (j = l; j <= u; j++)
+            {
+                gmc_poly2array(v, Rm[j], B + iB[j], iB[j + 1] - iB[j], ctx);
+                result &= _vec_equal(v, Rd[j], iB[j + 1] - iB[j], ctx);
+            }
+
+            if (!result)
+            {
+                printf("FAIL:\n\n");
+                printf("k = %ld\n", k);
+                printf("Q = "), mpoly_print(Q, ctx), printf("\n");
+                for (j = l; j <= u; j++)
+                {
+                    printf("Rm[%ld] = ", j), mpoly_print(Rm[j], ctx), printf("\n");
+                    printf("Rd[%ld] = ", j);
+                    _vec_print(Rd[j], iB[j + 1] - iB[j], ctx), printf("\n");
+                }
+                abort();
+            }
+
+            _vec_clear(q, L[k]->len, ctx);
+        }
+
+        /* Check that reducing several columns at once agrees */
+        for (i = 0; i < RUNS / 5; i++)
+        {
+            const long r = n_randint(state, 5) + 1;
+
+            long c, q, lenW;
+            char *Qr, **Rr, *W;
+
+            k = k0 + n_randint(state, u + 2 - k0);
+
+            Qr = _vec_init(L[k]->len * r, ctx);
+            Rr = malloc((u + 1) * sizeof(char *));
+            for (j = l; j <= u; j++)
+                Rr[j] = _vec_init((iB[j + 1] - iB[j]) * r + 1, ctx);
+            lenW = _gmc_reduce_dense_mat_worklen(L, k, r);
+            W = _vec_init(lenW, ctx);
+
+            _vec_randtest(Qr, L[k]->len * r, state, ctx);
+
+            _gmc_reduce_dense_mat(Rr, Qr, r, k, L, s, l, u, W, ctx);
+
+            result = 1;
+            for (c = 0; c < r; c++)
+            {
+                char *q1 = _vec_init(L[k]->len, ctx);
+
+                for (q = 0; q < L[k]->len; q++)
+                    ctx->set(ctx, q1 + q * ctx->size, Qr + (q * r + c) * ctx->size);
+
+                gmc_reduce_dense(Rd, q1, k, L, s, l, u, ctx);
+
+                for (j = l; j <= u; j++)
+                    for (q = 0; q < iB[j + 1] - iB[j]; q++)
+                        result &= ctx->equal(ctx, Rd[j] + q * ctx->size, 
+                                             Rr[j] + (q * r + c) * ctx->size);
+
+                _vec_clear(q1, L[k]->len, ctx);
+            }
+
+            if (!result)
+            {
+                printf("FAIL (batched):\n\n");
+                printf("k = %ld, r = %ld\n", k, r);
+                printf("Q = "), _vec_print(Qr, L[k]->len * r, ctx), printf("\n");
+                abort();
+            }
+
+            _vec_clear(Qr, L[k]->len * r, ctx);
+            for (j = l; j <= u; j++)
+                _vec_clear(Rr[j], (iB[j + 1] - iB[j]) * r + 1, ctx);
+            free(Rr);
+            _vec_clear(W, lenW, ctx);
+        }
+
+        mpoly_clear(Q, ctx);
+        _vec_clear(v, lenB, ctx);
+        for (k = l; k <= u; k++)
+            _vec_clear(Rd[k], iB[k + 1] - iB[k], ctx);
+        free(Rd);
+        for (k = 0; k <= n + 1; k++)
+            mpoly_clear(Rm[k], ctx);
+        free(Rm);
+
+        for (k = k0; k <= u + 1; k++)
+        {
+            free(rows[k]);
+            free(cols[k]);
+            free(p[k]);
+            mat_csr_clear(aux[k], ctx);
+            mat_csr_solve_clear(s[k], ctx);
+        }
+        for (k = 0; k <= u + 1; k++)
+            gmc_level_clear(L[k], ctx);
+        free(aux);
+        free(s);
+        free(rows);
+        free(cols);
+        free(p);
+        free(L);
+
+        for (j = 0; j <= n; j++)
+            mpoly_clear(dP[j], ctx);
+        free(dP);
+        mpoly_clear(P, ctx);
+        free(B);
+        free(iB);
+    }
+
+    ctx_clear(ctx);
+
+    _randclear(state);
+    _fmpz_cleanup();
+    printf("PASS\n");
+    return EXIT_SUCCESS;
+}
+
@@ -27,6 +27,10 @@ void gmde_solve_fmpq(fmpq_mat_struct **C, long N,
 void gmde_solve(padic_mat_struct **C, long K, const fmpz_t p, long N, long Nw, 
                 const mat_t M, const ctx_t ctxM);
 
+void gmde_inv_series(fmpz_poly_mat_t B, long *vB, 
+                     const fmpz_poly_mat_t A, long vA, long K, 
+                     const fmpz_t p, long N, long Nw);
+
 void gmde_convert_soln_fmpq(mat_t A, const ctx_t ctxA, 
                             const fmpq_mat_struct *C, long N);
 
@@ -39,5 +43,9 @@ void gmde_convert_soln(fmpz_poly_mat_t A, long *vA,
 void gmde_check_soln(const fmpz_poly_mat_t C, long vC, const fmpz_t p, long N, 
                      long K, const mat_t M, const ctx_t FracZt);
 
+int gmde_check_soln_random(const fmpz_poly_mat_t C, long vC, const fmpz_t p, 
+                           long N, long K, const mat_t M, const ctx_t FracZt, 
+                           flint_rand_t state);
+
 #endif
 
@@ -4,9 +4,13 @@
 
 ******************************************************************************/
 
+#include <math.h>
+
 #include "flint/flint.h"
+#include "flint/fmpz_vec.h"
 #include "flint/fmpq_poly.h"
 
+#include "gmconnection.h"
 #include "gmde.h"
 
 /*
@@ -85,3 +89,134 @@ void gmde_check_soln(const fmpz_poly_mat_t C, long vC, const fmpz_t p, long N,
     fmpz_poly_mat_clear(T);
 }
 
+
+/*
+    Probabilistic version of the above.  Picks random vectors $v$ and $w$ 
+    modulo $p^{N - v_C}$ and checks that the scalar series 
+    \begin{equation*}
+    w^t \bigl( r \tfrac{d}{dt} + B \bigr) C v
+    \end{equation*}
+    vanishes modulo $(p^{N - v_C}, t^{K-1})$, where $M = B / r$. 
+    Only matrix--vector products and $b$ polynomial multiplications 
+    are needed per trial.
+
+    If $(d/dt + M) C$ is non-zero at this precision, a single trial 
+    passes with probability at most $(2p-1)/p^2$, and the number of 
+    trials is chosen so that an incorrect solution is accepted with 
+    probability less than $2^{-40}$.
+
+    Rather than reducing modulo a random small prime or evaluating 
+    at a random point, the system is only projected onto random 
+    vectors.  Since $C$ is only known modulo $p^N$, the residual 
+    vanishes modulo $p^{N - v_C}$ but not over $\mathbf{Z}$, so it 
+    cannot be tested modulo another prime, and evaluation at $t = a$ 
+    does not commute with the truncation modulo $t^{K-1}$.
+
+    Returns $1$ if all trials pass, and $0$ otherwise.
+ */
+
+int gmde_check_soln_random(const fmpz_poly_mat_t C, long vC, const fmpz_t p, 
+                           long N, long K, const mat_t M, const ctx_t FracZt, 
+                           flint_rand_t state)
+{
+    const long b = M->m;
+
+    long i, j, reps, trial;
+    int result = 1;
+
+    fmpz_poly_t r, s, t, *u, *z;
+    fmpz_poly_mat_t Mn;
+    fmpz *v, *w;
+    fmpz_t pN;
+
+    if (K < 2 || N - vC <= 0)
+        return 1;
+
+    /* Number of trials */
+    {
+        const double e = (2.0 * fmpz_get_d(p) - 1.0) 
+                       / (fmpz_get_d(p) * fmpz_get_d(p));
+
+        reps = (long) (40.0 / (- log(e) / log(2.0))) + 1;
+    }
+
+    fmpz_init(pN);
+    fmpz_pow_ui(pN, p, N - vC);
+
+    fmpz_poly_init(r);
+    fmpz_poly_init(s);
+    fmpz_poly_init(t);
+    fmpz_poly_mat_init(Mn, b, b);
+
+    u = malloc(b * sizeof(fmpz_poly_t));
+    z = malloc(b * sizeof(fmpz_poly_t));
+    for (i = 0; i < b; i++)
+    {
+        fmpz_poly_init(u[i]);
+        fmpz_poly_init(z[i]);
+    }
+    v = _fmpz_vec_init(b);
+    w = _fmpz_vec_init(b);
+
+    /* Express M as Mn / r */
+    gmc_convert(Mn, r, M, FracZt);
+
+    for (trial = 0; result && trial < reps; trial++)
+    {
+        for (i = 0; i < b; i++)
+        {
+            fmpz_randm(v + i, state, pN);
+            fmpz_randm(w + i, state, pN);
+        }
+
+        /* u := C v, z := w^t Mn */
+        for (i = 0; i < b; i++)
+        {
+            fmpz_poly_zero(u[i]);
+            fmpz_poly_zero(z[i]);
+            for (j = 0; j < b; j++)
+            {
+                fmpz_poly_scalar_addmul_fmpz(u[i], 
+                    fmpz_poly_mat_entry(C, i, j), v + j);
+                fmpz_poly_scalar_addmul_fmpz(z[i], 
+                    fmpz_poly_mat_entry(Mn, j, i), w + j);
+            }
+            fmpz_poly_truncate(u[i], K);
+            fmpz_poly_scalar_mod_fmpz(u[i], u[i], pN);
+            fmpz_poly_scalar_mod_fmpz(z[i], z[i], pN);
+        }
+
+        /* s := r (w^t u)' + z u */
+        fmpz_poly_zero(t);
+        for (i = 0; i < b; i++)
+            fmpz_poly_scalar_addmul_fmpz(t, u[i], w + i);
+        fmpz_poly_derivative(t, t);
+        fmpz_poly_mullow(s, r, t, K - 1);
+
+        for (i = 0; i < b; i++)
+        {
+            fmpz_poly_mullow(t, z[i], u[i], K - 1);
+            fmpz_poly_add(s, s, t);
+        }
+        fmpz_poly_scalar_mod_fmpz(s, s, pN);
+
+        result = fmpz_poly_is_zero(s);
+    }
+
+    fmpz_clear(pN);
+    fmpz_poly_clear(r);
+    fmpz_poly_clear(s);
+    fmpz_poly_clear(t);
+    fmpz_poly_mat_clear(Mn);
+    for (i = 0; i < b; i++)
+    {
+        fmpz_poly_clear(u[i]);
+        fmpz_poly_clear(z[i]);
+    }
+    free(u);
+    free(z);
+    _fmpz_vec_clear(v, b);
+    _fmpz_vec_clear(w, b);
+
+    return result;
+}
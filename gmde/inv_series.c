@@ -0,0 +1,186 @@
+/******************************************************************************
+
+    Copyright (C) 2012 Sebastian Pancratz
+
+******************************************************************************/
+
+#include <stdlib.h>
+#include <assert.h>
+#include <limits.h>
+
+#include "flint/fmpz_vec.h"
+
+#include "gmde.h"
+
+static
+void _fmpz_poly_mat_scalar_mod_fmpz(fmpz_poly_mat_t B,
+                                    const fmpz_poly_mat_t A, const fmpz_t f)
+{
+    long i, j;
+
+    for (i = 0; i < A->r; i++)
+        for (j = 0; j < A->c; j++)
+            fmpz_poly_scalar_mod_fmpz(fmpz_poly_mat_entry(B, i, j),
+                                      fmpz_poly_mat_entry(A, i, j), f);
+}
+
+static
+void _fmpz_poly_mat_scalar_divexact_fmpz(fmpz_poly_mat_t B,
+                                         const fmpz_poly_mat_t A, const fmpz_t f)
+{
+    long i, j;
+
+    for (i = 0; i < A->r; i++)
+        for (j = 0; j < A->c; j++)
+            fmpz_poly_scalar_divexact_fmpz(fmpz_poly_mat_entry(B, i, j),
+                                           fmpz_poly_mat_entry(A, i, j), f);
+}
+
+/*
+    Removes the largest power of p dividing all entries of A, 
+    adjusting the valuation vA accordingly.
+ */
+static
+void _fmpz_poly_mat_canonicalise(fmpz_poly_mat_t A, long *vA, const fmpz_t p)
+{
+    long i, j, v = LONG_MAX;
+
+    for (i = 0; i < A->r; i++)
+        for (j = 0; j < A->c; j++)
+        {
+            const fmpz_poly_struct *poly = fmpz_poly_mat_entry(A, i, j);
+
+            if (!fmpz_poly_is_zero(poly))
+                v = FLINT_MIN(v, _fmpz_vec_ord_p(poly->coeffs, 
+                                                 poly->length, p));
+        }
+
+    if (v == LONG_MAX)
+    {
+        *vA = 0;
+    }
+    else if (v > 0)
+    {
+        fmpz_t f;
+
+        fmpz_init(f);
+        fmpz_pow_ui(f, p, v);
+        _fmpz_poly_mat_scalar_divexact_fmpz(A, A, f);
+        *vA += v;
+        fmpz_clear(f);
+    }
+}
+
+/*
+    Sets (B, vB) to (A, vA) + (C, vC), where the pairs denote the
+    matrices p^{vA} A etc.  Neither A nor C may be aliased with B.
+ */
+static
+void _fmpz_poly_mat_add_val(fmpz_poly_mat_t B, long *vB,
+                            const fmpz_poly_mat_t A, long vA,
+                            const fmpz_poly_mat_t C, long vC,
+                            const fmpz_t p)
+{
+    fmpz_t f;
+
+    fmpz_init(f);
+
+    if (vA <= vC)
+    {
+        fmpz_pow_ui(f, p, vC - vA);
+        fmpz_poly_mat_scalar_mul_fmpz(B, C, f);
+        fmpz_poly_mat_add(B, B, A);
+        *vB = vA;
+    }
+    else
+    {
+        fmpz_pow_ui(f, p, vA - vC);
+        fmpz_poly_mat_scalar_mul_fmpz(B, A, f);
+        fmpz_poly_mat_add(B, B, C);
+        *vB = vC;
+    }
+
+    fmpz_clear(f);
+}
+
+void gmde_inv_series(fmpz_poly_mat_t B, long *vB,
+                     const fmpz_poly_mat_t A, long vA, long K,
+                     const fmpz_t p, long N, long Nw)
+{
+    const long b = A->r;
+
+    fmpz_poly_mat_t I, X, T, E;
+    long vX, vE;
+    long *a, i, n;
+    fmpz_t pN;
+
+    assert(K > 0);
+    assert(A->r == A->c && B->r == b && B->c == b);
+
+    fmpz_poly_mat_init(I, b, b);
+    fmpz_poly_mat_init(X, b, b);
+    fmpz_poly_mat_init(T, b, b);
+    fmpz_poly_mat_init(E, b, b);
+    fmpz_init(pN);
+
+    /* Lengths of the Newton iteration, a[0] = K > a[1] > ... > a[n-1] = 1 */
+    for (n = 1, i = K; i > 1; i = (i + 1) / 2)
+        n++;
+    a = malloc(n * sizeof(long));
+    for (a[0] = K, i = 1; i < n; i++)
+        a[i] = (a[i - 1] + 1) / 2;
+
+    /* Since p^{vA} A(0) = I, we start with X = I modulo t */
+    fmpz_poly_mat_one(I);
+    fmpz_poly_mat_one(X);
+    vX = 0;
+
+    for (i = n - 2; i >= 0; i--)
+    {
+        const long len = a[i];
+
+        /* E := I - p^{vA + vX} A X, which vanishes modulo t^{a[i+1]} */
+        fmpz_poly_mat_mullow(T, A, X, len);
+        fmpz_poly_mat_neg(T, T);
+        _fmpz_poly_mat_add_val(E, &vE, I, 0, T, vA + vX, p);
+
+        /* X := X + X E modulo t^{len} */
+        fmpz_poly_mat_mullow(T, X, E, len);
+        fmpz_poly_mat_set(E, X);
+        _fmpz_poly_mat_add_val(X, &vX, E, vX, T, vX + vE, p);
+
+        /* Discard digits beyond the working precision */
+        _fmpz_poly_mat_canonicalise(X, &vX, p);
+        if (Nw - vX > 0)
+        {
+            fmpz_pow_ui(pN, p, Nw - vX);
+            _fmpz_poly_mat_scalar_mod_fmpz(X, X, pN);
+        }
+    }
+
+    fmpz_poly_mat_truncate(X, K);
+
+    /* Canonicalise (X, vX) and reduce to precision N */
+    _fmpz_poly_mat_canonicalise(X, &vX, p);
+
+    if (N - vX > 0)
+    {
+        fmpz_pow_ui(pN, p, N - vX);
+        _fmpz_poly_mat_scalar_mod_fmpz(X, X, pN);
+    }
+    else
+    {
+        fmpz_poly_mat_zero(X);
+        vX = 0;
+    }
+
+    fmpz_poly_mat_swap(B, X);
+    *vB = vX;
+
+    free(a);
+    fmpz_poly_mat_clear(I);
+    fmpz_poly_mat_clear(X);
+    fmpz_poly_mat_clear(T);
+    fmpz_poly_mat_clear(E);
+    fmpz_clear(pN);
+}
@@ -7,80 +7,157 @@
 #include <stdlib.h>
 #include <assert.h>
 
+#include "flint/fmpz_vec.h"
+#include "flint/fmpz_mat.h"
+#include "flint/fmpz_poly_mat.h"
+
+#include "gmconnection.h"
 #include "gmde.h"
 
+/*
+    The recurrence 
+
+        C[i+1] = - (sum_j B[i-j] C[j] + sum_j r[i-j+1] j C[j]) / ((i+1) r0)
+
+    has integer matrices B[k] and integer coefficients r[k], and C[0] is 
+    the identity.  Thus C[i] = N[i] / D[i] where N[i] is an integer matrix 
+    and D[i] = i! r0^i, and we run the recurrence on the numerators only, 
+    scaling N[j] by D[i] / D[j] = (i! / j!) r0^{i-j}.  Canonical fractions 
+    are only formed once, when the output is written.
+ */
+
 void gmde_solve_fmpq(fmpq_mat_struct **C, long K, 
                      const mat_t M, const ctx_t ctxM)
 {
     const long n = M->m;
 
-    fmpq_mat_struct *B;
+    fmpz_mat_struct *B, *N;
+    fmpz *D;
     long lenB;
 
     fmpz_poly_t r;
     fmpz * r0;
     long lenR;
 
-    long i, j;
+    long i, j, k;
+
+    assert(M->m == M->n);
 
     /* Initialisation */
     fmpz_poly_init(r);
 
-    /* Initialise C */
-    *C = malloc(K * sizeof(fmpq_mat_struct));
-    for (i = 0; i < K; i++)
-        fmpq_mat_init(*C + i, n, n);
-
     /* Express M as B / r */
-    gmde_convert_gmc_fmpq(&B, &lenB, r, M, ctxM);
+    {
+        fmpz_poly_mat_t t;
+
+        fmpz_poly_mat_init(t, n, n);
+        gmc_convert(t, r, M, ctxM);
+
+        lenB = 0;
+        for (i = 0; i < n; i++)
+            for (j = 0; j < n; j++)
+                lenB = FLINT_MAX(lenB, 
+                    fmpz_poly_length(fmpz_poly_mat_entry(t, i, j)));
+
+        B = malloc(lenB * sizeof(fmpz_mat_struct));
+        for (k = 0; k < lenB; k++)
+            fmpz_mat_init(B + k, n, n);
+
+        for (i = 0; i < n; i++)
+            for (j = 0; j < n; j++)
+            {
+                const fmpz_poly_struct *poly = fmpz_poly_mat_entry(t, i, j);
+
+                for (k = 0; k < fmpz_poly_length(poly); k++)
+                    fmpz_set(fmpz_mat_entry(B + k, i, j), 
+                             fmpz_poly_get_coeff_ptr(poly, k));
+            }
+
+        fmpz_poly_mat_clear(t);
+    }
 
     r0   = fmpz_poly_get_coeff_ptr(r, 0);
     lenR = fmpz_poly_length(r);
 
+    /* Initialise numerators and denominators */
+    N = malloc(K * sizeof(fmpz_mat_struct));
+    D = _fmpz_vec_init(K);
+    for (i = 0; i < K; i++)
+        fmpz_mat_init(N + i, n, n);
+
     /* Solve the differential system iteratively */
     {
-        fmpq_mat_t mat;
-        fmpz_t coeff;
+        fmpz_mat_t mat;
+        fmpz_t coeff, f;
 
-        fmpq_mat_init(mat, n, n);
+        fmpz_mat_init(mat, n, n);
         fmpz_init(coeff);
+        fmpz_init(f);
 
-        fmpq_mat_one(*C + 0);
+        fmpz_mat_one(N + 0);
+        fmpz_one(D + 0);
 
         for (i = 0; i < K - 1; i++)
         {
-            fmpq_mat_zero(*C + (i + 1));
+            fmpz_mat_zero(N + (i + 1));
 
-            j = FLINT_MAX(0, i - lenB + 1);
-            for ( ; j <= i; j++)
+            /* f = D[i] / D[j], starting with j = i */
+            fmpz_one(f);
+            for (j = i; j >= FLINT_MAX(0, i - lenB + 1); j--)
             {
-                /* C[i+1] = C[i+1] + b[i-j] * C[j]; */
-                fmpq_mat_mul(mat, B + (i - j), *C + j);
-                fmpq_mat_add(*C + (i + 1), *C + (i + 1), mat);
+                if (j < i)
+                {
+                    fmpz_mul_ui(f, f, j + 1);
+                    fmpz_mul(f, f, r0);
+                }
+
+                /* N[i+1] = N[i+1] + f * b[i-j] * N[j]; */
+                fmpz_mat_mul(mat, B + (i - j), N + j);
+                fmpz_mat_scalar_addmul_fmpz(N + (i + 1), mat, f);
             }
 
-            j = FLINT_MAX(0, i - lenR + 1) + 1;
-            for ( ; j <= i; j++)
+            fmpz_one(f);
+            for (j = i; j >= FLINT_MAX(0, i - lenR + 1) + 1; j--)
             {
-                /* C[i+1] = C[i+1] + r[i-j+1] * j * C[j]; */
+                if (j < i)
+                {
+                    fmpz_mul_ui(f, f, j + 1);
+                    fmpz_mul(f, f, r0);
+                }
+
+                /* N[i+1] = N[i+1] + f * r[i-j+1] * j * N[j]; */
                 fmpz_mul_ui(coeff, fmpz_poly_get_coeff_ptr(r, i - j + 1), j);
-                fmpq_mat_scalar_mul_fmpz(mat, *C + j, coeff);
-                fmpq_mat_add(*C + (i + 1), *C + (i + 1), mat);
+                fmpz_mul(coeff, coeff, f);
+                fmpz_mat_scalar_addmul_fmpz(N + (i + 1), N + j, coeff);
             }
 
-            fmpz_mul_si(coeff, r0, -(i + 1));
-            fmpq_mat_scalar_div_fmpz(*C + (i + 1), *C + (i + 1), coeff);
+            fmpz_mat_neg(N + (i + 1), N + (i + 1));
+            fmpz_mul_ui(D + (i + 1), D + i, i + 1);
+            fmpz_mul(D + (i + 1), D + (i + 1), r0);
         }
 
-        fmpq_mat_clear(mat);
+        fmpz_mat_clear(mat);
         fmpz_clear(coeff);
+        fmpz_clear(f);
+    }
+
+    /* Write out the canonical fractions */
+    *C = malloc(K * sizeof(fmpq_mat_struct));
+    for (i = 0; i < K; i++)
+    {
+        fmpq_mat_init(*C + i, n, n);
+        fmpq_mat_set_fmpz_mat_div_fmpz(*C + i, N + i, D + i);
     }
 
     /* Clean-up */
     for (i = 0; i < lenB; i++)
-        fmpq_mat_clear(B + i);
+        fmpz_mat_clear(B + i);
     free(B);
 
+    for (i = 0; i < K; i++)
+        fmpz_mat_clear(N + i);
+    free(N);
+    _fmpz_vec_clear(D, K);
+
     fmpz_poly_clear(r);
 }
-
@@ -0,0 +1,152 @@
+/******************************************************************************
+
+    Copyright (C) 2012 Sebastian Pancratz
+
+******************************************************************************/
+
+#include <stdlib.h>
+
+#include "generics.h"
+#include "mat.h"
+#include "gmconnection.h"
+#include "gmde.h"
+
+#include "flint/flint.h"
+#include "flint/fmpz_poly.h"
+#include "flint/fmpz_poly_q.h"
+#include "flint/fmpz_poly_mat.h"
+#include "flint/ulong_extras.h"
+
+int main(void)
+{
+    const char *str[2] = {
+        "3  [3 0 0] [0 3 0] [0 0 3] (2  0 1)[1 1 1]", 
+        "3  [3 0 0] [0 3 0] [0 0 3] (2  0 1)[2 1 0] (2  0 1)[0 2 1] (2  0 1)[1 0 2]"
+    };
+    const ulong primes[3] = {5, 7, 11};
+
+    int i, l;
+    flint_rand_t state;
+
+    printf("check_soln_random... ");
+    fflush(stdout);
+
+    _randinit(state);
+
+    for (i = 0; i < 2; i++)
+    for (l = 0; l < 3; l++)
+    {
+        const long K = 20, N = 10, Nw = 20;
+
+        mpoly_t P;
+        mat_t M;
+        ctx_t ctxM;
+        mon_t *rows, *cols;
+        padic_mat_struct *C;
+        fmpz_poly_mat_t A, Mn;
+        fmpz_poly_t r0;
+        fmpz_t p, d;
+        long b, k, vA;
+        int n, result;
+
+        n = atoi(str[i]) - 1;
+
+        fmpz_init(p);
+        fmpz_init(d);
+        fmpz_set_ui(p, primes[l]);
+        ctx_init_fmpz_poly_q(ctxM);
+
+        mpoly_init(P, n + 1, ctxM);
+        mpoly_set_str(P, str[i], ctxM);
+
+        b = gmc_basis_size(n, mpoly_degree(P, -1, ctxM));
+
+        mat_init(M, b, b, ctxM);
+        fmpz_poly_mat_init(A, b, b);
+        fmpz_poly_mat_init(Mn, b, b);
+        fmpz_poly_init(r0);
+
+        gmc_compute(M, &rows, &cols, P, ctxM);
+        gmc_convert(Mn, r0, M, ctxM);
+
+        gmde_solve(&C, K, p, N, Nw, M, ctxM);
+        gmde_convert_soln(A, &vA, C, K, p);
+
+        /* The correct solution is accepted */
+        result = gmde_check_soln_random(A, vA, p, N, K, M, ctxM, state);
+        if (!result)
+        {
+            printf("FAIL (correct solution rejected):\n\n");
+            printf("P = %s, p = %lu\n", str[i], primes[l]);
+            abort();
+        }
+
+        /*
+            Perturbing a single coefficient of t^e of A, with p \nmid e, 
+            by a unit d changes the residual (r d/dt + B) A first in 
+            its coefficient of t^{e-1}, by e r(0) d.  This is non-zero 
+            modulo p^{N - vA} unless p^{N - vA} divides r(0).
+         */
+        fmpz_poly_get_coeff_fmpz(d, r0, 0);
+        fmpz_pow_ui(p, p, N - vA);
+        if (fmpz_divisible(d, p))
+            k = 10;
+        else
+            k = 0;
+        fmpz_set_ui(p, primes[l]);
+
+        for ( ; k < 10; k++)
+        {
+            const long r = n_randint(state, b);
+            const long c = n_randint(state, b);
+            long e;
+            fmpz_poly_struct *poly = fmpz_poly_mat_entry(A, r, c);
+
+            do
+                e = n_randint(state, K - 2) + 1;
+            while (e % primes[l] == 0);
+
+            fmpz_set_ui(d, n_randint(state, primes[l] - 1) + 1);
+
+            fmpz_poly_get_coeff_fmpz(p, poly, e);
+            fmpz_add(p, p, d);
+            fmpz_poly_set_coeff_fmpz(poly, e, p);
+            fmpz_set_ui(p, primes[l]);
+
+            result = !gmde_check_soln_random(A, vA, p, N, K, M, ctxM, state);
+            if (!result)
+            {
+                printf("FAIL (perturbed solution accepted):\n\n");
+                printf("P = %s, p = %lu\n", str[i], primes[l]);
+                printf("Entry (%ld, %ld), coefficient %ld\n", r, c, e);
+                abort();
+            }
+
+            fmpz_poly_get_coeff_fmpz(p, poly, e);
+            fmpz_sub(p, p, d);
+            fmpz_poly_set_coeff_fmpz(poly, e, p);
+            fmpz_set_ui(p, primes[l]);
+        }
+
+        mpoly_clear(P, ctxM);
+        mat_clear(M, ctxM);
+        free(rows);
+        free(cols);
+        fmpz_poly_mat_clear(A);
+        fmpz_poly_mat_clear(Mn);
+        fmpz_poly_clear(r0);
+        ctx_clear(ctxM);
+        fmpz_clear(p);
+        fmpz_clear(d);
+
+        for (k = 0; k < K; k++)
+            padic_mat_clear(C + k);
+        free(C);
+    }
+
+    _randclear(state);
+    _fmpz_cleanup();
+    printf("PASS\n");
+    return EXIT_SUCCESS;
+}
+
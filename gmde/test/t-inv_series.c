@@ -0,0 +1,169 @@
+/******************************************************************************
+
+    Copyright (C) 2012 Sebastian Pancratz
+
+******************************************************************************/
+
+#include <stdlib.h>
+#include <limits.h>
+
+#include "generics.h"
+#include "mat.h"
+#include "gmconnection.h"
+#include "gmde.h"
+#include "deformation.h"
+
+#include "flint/flint.h"
+#include "flint/fmpz_vec.h"
+#include "flint/fmpz_poly.h"
+#include "flint/fmpz_poly_q.h"
+#include "flint/fmpz_poly_mat.h"
+#include "flint/ulong_extras.h"
+
+int main(void)
+{
+    char *str;  /* String for the input polynomial P */
+    mpoly_t P;  /* Input polynomial P */
+    int n;      /* Number of variables minus one */
+    long K;     /* Required t-adic precision */
+    long N, Nw;
+    long b;     /* Matrix dimensions */
+    long i, j, s, v;
+    prec_t prec;
+
+    mat_t M;
+    ctx_t ctxM;
+
+    mon_t *rows, *cols;
+
+    padic_mat_struct *C;
+    fmpz_t p;
+
+    fmpz_poly_mat_t A, B, T;
+    long vA, vB;
+    fmpz_poly_t r, t;
+
+    printf("inv_series... ");
+    fflush(stdout);
+
+    /* Example 3-1-1 */
+    str = "3  [3 0 0] [0 3 0] [0 0 3] (2  0 1)[1 1 1]";
+
+    n  = atoi(str) - 1;
+
+    fmpz_init(p);
+    fmpz_set_ui(p, 5);
+    ctx_init_fmpz_poly_q(ctxM);
+
+    mpoly_init(P, n + 1, ctxM);
+    mpoly_set_str(P, str, ctxM);
+
+    b = gmc_basis_size(n, mpoly_degree(P, -1, ctxM));
+
+    mat_init(M, b, b, ctxM);
+    fmpz_poly_mat_init(A, b, b);
+    fmpz_poly_mat_init(B, b, b);
+    fmpz_poly_mat_init(T, b, b);
+    fmpz_poly_init(r);
+    fmpz_poly_init(t);
+
+    gmc_compute(M, &rows, &cols, P, ctxM);
+
+    fmpz_poly_set_ui(r, 1);
+    for (i = 0; i < b; i++)
+        for (j = 0; j < b; j++)
+        {
+            fmpz_poly_lcm(t, r, fmpz_poly_q_denref(
+                (fmpz_poly_q_struct *) mat_entry(M, i, j, ctxM)));
+            fmpz_poly_swap(r, t);
+        }
+
+    /*
+        The precisions that frob_ret() uses when computing C^{-1}(t) 
+        modulo t^L by Newton inversion, where L = ceil(K/p)
+     */
+    deformation_precisions(&prec, p, 1, n, 
+                           mpoly_degree(P, -1, ctxM), fmpz_poly_degree(r));
+
+    K  = (prec.K + (*p) - 1) / (*p);
+    N  = prec.N3i;
+    Nw = prec.N3nw;
+
+    gmde_solve(&C, prec.K, p, prec.N3n, prec.N3nw, M, ctxM);
+    gmde_convert_soln(A, &vA, C, prec.K, p);
+
+    gmde_inv_series(B, &vB, A, vA, K, p, N, Nw);
+
+    /* The condition on Nw in the documentation of gmde_inv_series() */
+    s = n_clog(K, 2);
+
+    if (Nw < N - s * (vA + vB))
+    {
+        printf("FAIL (working precision):\n\n");
+        printf("N = %ld, Nw = %ld, s = %ld\n", N, Nw, s);
+        printf("vA = %ld, vB = %ld\n", vA, vB);
+        abort();
+    }
+
+    /* Check that p^{vA + vB} A B == I modulo (p^{N + vA}, t^K) */
+    fmpz_poly_mat_mullow(T, A, B, K);
+    {
+        fmpz_t f;
+
+        fmpz_init(f);
+        if (vA + vB >= 0)
+        {
+            fmpz_pow_ui(f, p, vA + vB);
+            fmpz_poly_mat_scalar_mul_fmpz(T, T, f);
+            fmpz_pow_ui(f, p, 0);
+        }
+        else
+        {
+            fmpz_pow_ui(f, p, - (vA + vB));
+        }
+        for (i = 0; i < b; i++)
+            fmpz_poly_sub_fmpz(fmpz_poly_mat_entry(T, i, i),
+                               fmpz_poly_mat_entry(T, i, i), f);
+        fmpz_clear(f);
+    }
+
+    v = LONG_MAX;
+    for (i = 0; i < b; i++)
+        for (j = 0; j < b; j++)
+        {
+            const fmpz_poly_struct *poly = fmpz_poly_mat_entry(T, i, j);
+
+            if (!fmpz_poly_is_zero(poly))
+                v = FLINT_MIN(v, _fmpz_vec_ord_p(poly->coeffs, poly->length, p));
+        }
+    if (v != LONG_MAX)
+        v += FLINT_MIN(vA + vB, 0);
+
+    if (v < N + vA)
+    {
+        printf("FAIL:\n\n");
+        printf("vA = %ld, vB = %ld\n", vA, vB);
+        printf("ord_p(C C^{-1} - I) = %ld\n", v);
+        abort();
+    }
+
+    mpoly_clear(P, ctxM);
+    mat_clear(M, ctxM);
+    free(rows);
+    free(cols);
+    fmpz_poly_mat_clear(A);
+    fmpz_poly_mat_clear(B);
+    fmpz_poly_mat_clear(T);
+    fmpz_poly_clear(r);
+    fmpz_poly_clear(t);
+    ctx_clear(ctxM);
+    fmpz_clear(p);
+
+    for (i = 0; i < prec.K; i++)
+        padic_mat_clear(C + i);
+    free(C);
+
+    _fmpz_cleanup();
+    printf("PASS\n");
+    return EXIT_SUCCESS;
+}
@@ -116,6 +116,13 @@ void _mat_lup_solve(char *x, char ** const rows, long m, long n,
 void mat_lup_solve(char *x, const mat_t mat, const long *pi, 
                          const char *b, const ctx_t ctx);
 
+void _mat_lup_solve_mat(char *X, char ** const rows, long m, long n, 
+                        const long *pi, const char *B, long r, char *t, 
+                        const ctx_t ctx);
+
+void mat_lup_solve_mat(char *X, const mat_t mat, const long *pi, 
+                       const char *B, long r, const ctx_t ctx);
+
 int 
 _mat_lup_decompose(long *pi, char **rows, long m, const ctx_t ctx);
 
@@ -0,0 +1,76 @@
+#include <assert.h>
+
+#include "mat.h"
+#include "vec.h"
+
+void _mat_lup_solve_mat(char *X, char ** const rows, long m, long n, 
+                        const long *pi, const char *B, long r, char *t, 
+                        const ctx_t ctx)
+{
+    long c, i, j;
+
+    assert(m == n);
+    assert(X != B);
+
+    /*
+        Solve the lower unit-triangular system L Y = P B, updating 
+        whole rows of Y at a time so that each entry of L is loaded 
+        once for all r right-hand sides
+     */
+
+    for (i = 0; i < m; i++)
+    {
+        char *Xi = X + (i * r) * ctx->size;
+
+        _vec_set(Xi, B + (pi[i] * r) * ctx->size, r, ctx);
+        for (j = 0; j < i; j++)
+        {
+            const char *Lij = rows[i] + j * ctx->size;
+            const char *Xj  = X + (j * r) * ctx->size;
+
+            if (ctx->is_zero(ctx, Lij))
+                continue;
+
+            for (c = 0; c < r; c++)
+            {
+                ctx->mul(ctx, t, Lij, Xj + c * ctx->size);
+                ctx->sub(ctx, Xi + c * ctx->size, Xi + c * ctx->size, t);
+            }
+        }
+    }
+
+    /* Solve the upper triangular system U X = Y */
+
+    for (i = m - 1; i >= 0; i--)
+    {
+        char *Xi = X + (i * r) * ctx->size;
+
+        for (j = i + 1; j < m; j++)
+        {
+            const char *Uij = rows[i] + j * ctx->size;
+            const char *Xj  = X + (j * r) * ctx->size;
+
+            if (ctx->is_zero(ctx, Uij))
+                continue;
+
+            for (c = 0; c < r; c++)
+            {
+                ctx->mul(ctx, t, Uij, Xj + c * ctx->size);
+                ctx->sub(ctx, Xi + c * ctx->size, Xi + c * ctx->size, t);
+            }
+        }
+        for (c = 0; c < r; c++)
+            ctx->div(ctx, Xi + c * ctx->size, Xi + c * ctx->size, 
+                                              rows[i] + i * ctx->size);
+    }
+}
+
+void mat_lup_solve_mat(char *X, const mat_t mat, const long *pi, 
+                       const char *B, long r, const ctx_t ctx)
+{
+    char *t = _vec_init(1, ctx);
+
+    _mat_lup_solve_mat(X, mat->rows, mat->m, mat->n, pi, B, r, t, ctx);
+    _vec_clear(t, 1, ctx);
+}
+
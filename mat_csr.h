@@ -8,6 +8,8 @@
 #include <stdlib.h>
 #include <stdio.h>
 
+#include "flint/fmpz_poly_mat.h"
+
 #include "generics.h"
 #include "perm.h"
 #include "mat.h"
@@ -26,9 +28,78 @@ typedef struct
 
 typedef __mat_csr_struct mat_csr_t[1];
 
+/*
+    Diagonal blocks of length at least MAT_CSR_LU_SPARSE_MIN are first 
+    factored sparsely, provided the factors have at most a fraction 
+    1 / MAT_CSR_LU_SPARSE_FILL of the entries of the dense block
+ */
+#define MAT_CSR_LU_SPARSE_MIN   64
+#define MAT_CSR_LU_SPARSE_FILL  4
+
+/*
+    Sparse factorisation P A Q = L U of a square block of length len, 
+    where row t of P A Q is row rp[t] of A and column t of P A Q is 
+    column cq[t] of A.  Row t of the unit lower triangular factor L is 
+    given by the entries Lx[e] in the columns Lj[e] < t, for Lp[t] <= 
+    e < Lp[t+1].  Row t of U is given by the entries Ux[e] in the 
+    columns Uj[e] of A, for Up[t] <= e < Up[t+1], starting with the 
+    pivot in column cq[t].  The structure is unused if len is zero.
+ */
+typedef struct
+{
+    long len;
+    long *rp;
+    long *cq;
+    long *Lp;
+    long *Lj;
+    char *Lx;
+    long *Up;
+    long *Uj;
+    char *Ux;
+} __mat_csr_lu_struct;
+
+/*
+    Symbolic analysis of the sparsity pattern of a square matrix A for 
+    solving linear systems:  the pattern {j, p, lenr} of Q P A Q^t with 
+    the permutations pi (of Q P) and qi (of Q^{-1}), the nb diagonal 
+    blocks starting at the rows B[0], ..., B[nb-1], and the index 
+    {cp, ci, cq} of the entries below the diagonal blocks by block 
+    column.  The pattern has length alloc and addresses the values 
+    of A in their original positions.
+ */
+typedef struct
+{
+    long m;
+    long n;
+    long alloc;
+    long *j;
+    long *p;
+    long *lenr;
+    long *pi;
+    long *qi;
+    long *B;
+    long nb;
+    long *cp;
+    long *ci;
+    long *cq;
+} __mat_csr_analysis_struct;
+
+typedef __mat_csr_analysis_struct mat_csr_analysis_t[1];
+
 typedef struct
 {
-    /* Sparse matrix data;  x is only a reference */
+    /*
+        Symbolic analysis, which the structure owns if own is non-zero, 
+        and references to its data for convenience
+     */
+    __mat_csr_analysis_struct *A;
+    int own;
+
+    /*
+        Sparse matrix data;  x is only a reference, unless ownx is 
+        non-zero, in which case it has length A->alloc
+     */
+    int ownx;
     long m;
     long n;
     char *x;
@@ -42,10 +113,38 @@ typedef struct
     long *B;
     long nb;
 
+    /*
+        Off-diagonal entries by block column:  for cp[k] <= e < cp[k+1], 
+        the entry in position cq[e] of row ci[e] lies in block column k, 
+        below the diagonal block k, with the rows in increasing order
+     */
+    long *cp;
+    long *ci;
+    long *cq;
+
     /* Dense data, LUP decomposition */
     char *entries;
     char **LU;
     long *P;
+
+    /* Sparse factorisations, for the blocks k with F[k].len > 0 */
+    __mat_csr_lu_struct *F;
+
+    /*
+        Fraction-free data over Z[t], only if ff is non-zero:  row i 
+        is scaled by rho[i] so that all its entries xn[q] are integral, 
+        and the diagonal blocks without a sparse factorisation are 
+        stored in FFLU form in ffLU[k], the others as 0 x 0 matrices;  
+        row i lies in block blk[i], and the distinct blocks l < k with 
+        entries in the rows of block k are fl[fp[k]], ..., fl[fp[k+1]-1]
+     */
+    int ff;
+    fmpz_poly_struct *rho;
+    fmpz_poly_struct *xn;
+    fmpz_poly_mat_struct *ffLU;
+    long *blk;
+    long *fp;
+    long *fl;
 } __mat_csr_solve_struct;
 
 typedef __mat_csr_solve_struct mat_csr_solve_t[1];
@@ -110,16 +209,72 @@ long _mat_csr_block_triangularise(long *arp, long *b, long n, const long *j,
 long mat_csr_block_triangularise(long *pi, long *b, const mat_csr_t A, 
                                                     const ctx_t ctx);
 
-void mat_csr_solve_init(mat_csr_solve_t s, const mat_csr_t mat, 
-                        const ctx_t ctx);
+int _mat_csr_lu_sparse(__mat_csr_lu_struct *F, long len, 
+                       const char *x, const long *j, 
+                       const long *p, const long *lenr, long off, 
+                       long budget, const ctx_t ctx);
+
+void _mat_csr_lu_sparse_solve(char *x, const __mat_csr_lu_struct *F, 
+                              const char *b, const ctx_t ctx);
+
+void _mat_csr_lu_sparse_solve_mat(char *X, const __mat_csr_lu_struct *F, 
+                                  const char *B, long r, char *W, 
+                                  const ctx_t ctx);
+
+void _mat_csr_lu_sparse_clear(__mat_csr_lu_struct *F, const ctx_t ctx);
+
+void mat_csr_analysis_init(mat_csr_analysis_t A, const mat_csr_t mat);
+
+void mat_csr_analysis_clear(mat_csr_analysis_t A);
+
+int mat_csr_solve_init(mat_csr_solve_t s, const mat_csr_t mat, 
+                       const ctx_t ctx);
+
+int mat_csr_solve_init_ff(mat_csr_solve_t s, const mat_csr_t mat, 
+                          const ctx_t ctx);
+
+int mat_csr_solve_init_analysis(mat_csr_solve_t s, 
+                                const mat_csr_analysis_t A, 
+                                const mat_csr_t mat, const ctx_t ctx);
+
+int mat_csr_solve_init_analysis_ff(mat_csr_solve_t s, 
+                                   const mat_csr_analysis_t A, 
+                                   const mat_csr_t mat, const ctx_t ctx);
+
+int mat_csr_solve_refactor(mat_csr_solve_t s, const mat_csr_t mat, 
+                           const ctx_t ctx);
+
+void _mat_csr_solve_clear_numeric(mat_csr_solve_t s, const ctx_t ctx);
+
+void _mat_csr_solve_ff_index(mat_csr_solve_t s);
 
 void mat_csr_solve_clear(mat_csr_solve_t s, const ctx_t ctx);
 
 void mat_csr_solve(char *x, const mat_csr_solve_t s, const char *b, 
                    const ctx_t ctx);
 
+void mat_csr_solve_mat(char *X, const mat_csr_solve_t s, const char *B, 
+                       long r, const ctx_t ctx);
+
+long _mat_csr_solve_worklen(const mat_csr_solve_t s, long r);
+
+void _mat_csr_solve_mat(char *X, const mat_csr_solve_t s, const char *B, 
+                        long r, char *W, const ctx_t ctx);
+
+long _mat_csr_solve_ff_worklen(const mat_csr_solve_t s, long r);
+
+void _mat_csr_solve_ff(char *X, const mat_csr_solve_t s, const char *B, 
+                       long r, char *W, const ctx_t ctx);
+
 /* Input and output **********************************************************/
 
+/* Magic bytes at the start of a serialised solve structure */
+#define MAT_CSR_SOLVE_MAGIC  "MCS\001"
+
+int mat_csr_solve_out_raw(FILE *file, const mat_csr_solve_t s, const ctx_t ctx);
+
+int mat_csr_solve_inp_raw(mat_csr_solve_t s, FILE *file, const ctx_t ctx);
+
 int mat_csr_debug(const mat_csr_t A, const ctx_t ctx);
 
 int _mat_csr_print_dense(long m, long n, const char *x, const long *j, 
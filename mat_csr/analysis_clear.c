@@ -0,0 +1,11 @@
+#include <stdlib.h>
+
+#include "mat_csr.h"
+
+void mat_csr_analysis_clear(mat_csr_analysis_t A)
+{
+    free(A->j);
+    free(A->cp);
+    free(A->ci);
+}
+
@@ -0,0 +1,148 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "flint/flint.h"
+
+#include "mat_csr.h"
+
+#define DEBUG  0
+
+void mat_csr_analysis_init(mat_csr_analysis_t A, const mat_csr_t mat)
+{
+    long *w;
+    long *mem;
+    long i, m, nz;
+
+    assert(mat->m == mat->n);
+
+    m = mat->m;
+
+    #if (DEBUG > 0)
+    printf("mat_csr_analysis_init()\n");
+    printf("Matrix of size %ld x %ld\n", mat->m, mat->n);
+    fflush(stdout);
+    #endif
+
+    mem = malloc((mat->alloc + 5 * m + 1) * sizeof(long));
+    w   = malloc((3 * m) * sizeof(long));
+
+    if (!mem || !w)
+    {
+        printf("ERROR (mat_csr_analysis_init).  Memory allocation.\n\n");
+        abort();
+    }
+
+    A->m     = mat->m;
+    A->n     = mat->n;
+    A->alloc = mat->alloc;
+    A->j     = mem;
+    A->p     = mem + mat->alloc;
+    A->lenr  = mem + mat->alloc + m;
+    A->pi    = mem + mat->alloc + 2 * m;
+    A->qi    = mem + mat->alloc + 3 * m;
+    A->B     = mem + mat->alloc + 4 * m;
+
+    #if (DEBUG > 0)
+    printf("Calling mat_csr_zfdiagonal()\n");
+    fflush(stdout);
+    #endif
+
+    nz = mat_csr_zfdiagonal(A->pi, mat);
+
+    #if (DEBUG > 0)
+    printf("nz = %ld\n", nz);
+    printf("pi = {"); _perm_print(A->pi, m); printf("}\n");
+    fflush(stdout);
+    #endif
+
+    if (nz != m)
+    {
+        printf("ERROR (mat_csr_analysis_init).  Singular matrix.\n\n");
+        abort();
+    }
+
+    /* Copy the sparse structure of mat into {j, p, lenr} */
+
+    for (i = 0; i < m; i++)
+        A->lenr[i] = mat->lenr[i];
+    for (i = 0; i < m; i++)
+        A->p[i] = mat->p[i];
+    for (i = 0; i < mat->alloc; i++)
+        A->j[i] = mat->j[i];
+
+    /* Set A := P A */
+    _mat_csr_permute_rows(m, A->p, A->lenr, A->pi);
+
+    /* Find Q s.t. Q P A Q^t is block triangular */
+    A->nb = _mat_csr_block_triangularise(A->qi, A->B, m, A->j, A->p, A->lenr, w);
+    A->B[A->nb] = m;
+
+    _mat_csr_permute_rows(m, A->p, A->lenr, A->qi);
+
+    _mat_csr_permute_cols(m, m, A->j, A->p, A->lenr, A->qi);
+
+    #if (DEBUG > 0)
+    printf("nb = %ld\n", A->nb);
+    printf("B  = {"); _perm_print(A->B, A->nb); printf("}\n");
+    printf("qi = {"); _perm_print(A->qi, m); printf("}\n");
+    fflush(stdout);
+    #endif
+
+    /* Compose Q P, invert Q */
+
+    _perm_compose(w, A->pi, A->qi, m);
+    _perm_set(A->pi, w, m);
+
+    _perm_inv(A->qi, A->qi, m);
+
+    /* Index the off-diagonal entries by block column */
+    {
+        long *blk = w, *pos = w + m;
+        long e, k, q;
+
+        for (k = 0; k < A->nb; k++)
+            for (i = A->B[k]; i < A->B[k + 1]; i++)
+                blk[i] = k;
+
+        A->cp = calloc(A->nb + 1, sizeof(long));
+        if (!(A->cp))
+        {
+            printf("ERROR (mat_csr_analysis_init).  Memory allocation.\n\n");
+            abort();
+        }
+
+        for (i = 0; i < m; i++)
+            for (q = A->p[i]; q < A->p[i] + A->lenr[i]; q++)
+                if (blk[A->j[q]] < blk[i])
+                    A->cp[blk[A->j[q]] + 1]++;
+        for (k = 0; k < A->nb; k++)
+        {
+            A->cp[k + 1] += A->cp[k];
+            pos[k] = A->cp[k];
+        }
+
+        A->ci = malloc(FLINT_MAX(2 * A->cp[A->nb], 1) * sizeof(long));
+        A->cq = A->ci + A->cp[A->nb];
+
+        if (!(A->ci))
+        {
+            printf("ERROR (mat_csr_analysis_init).  Memory allocation.\n\n");
+            abort();
+        }
+
+        for (i = 0; i < m; i++)
+            for (q = A->p[i]; q < A->p[i] + A->lenr[i]; q++)
+                if (blk[A->j[q]] < blk[i])
+                {
+                    e = pos[blk[A->j[q]]]++;
+                    A->ci[e] = i;
+                    A->cq[e] = q;
+                }
+    }
+
+    /* Clean-up temporary space */
+
+    free(w);
+}
+
@@ -0,0 +1,327 @@
+#include <stdlib.h>
+
+#include "flint/flint.h"
+
+#include "vec.h"
+
+#include "mat_csr.h"
+
+/* Number of rows of least length searched for a Markowitz pivot */
+#define SEARCH  4
+
+/*
+    Working storage for a sparse row, with all alloc slots of x
+    initialised and the first n of them in use.
+ */
+typedef struct
+{
+    long n;
+    long alloc;
+    long *j;
+    char *x;
+} _row_struct;
+
+static void _row_fit_length(_row_struct *row, long len, const ctx_t ctx)
+{
+    if (len > row->alloc)
+    {
+        long i, alloc = FLINT_MAX(len, 2 * row->alloc);
+
+        row->j = realloc(row->j, alloc * sizeof(long));
+        row->x = realloc(row->x, alloc * ctx->size);
+        if (!(row->j) || !(row->x))
+        {
+            printf("ERROR (_mat_csr_lu_sparse).  Memory allocation.\n\n");
+            abort();
+        }
+        for (i = row->alloc; i < alloc; i++)
+            ctx->init(ctx, row->x + i * ctx->size);
+        row->alloc = alloc;
+    }
+}
+
+static void _row_clear(_row_struct *row, const ctx_t ctx)
+{
+    long i;
+
+    for (i = 0; i < row->alloc; i++)
+        ctx->clear(ctx, row->x + i * ctx->size);
+    free(row->j);
+    free(row->x);
+}
+
+/* Removes the entry in position e of the row, moving the last one there */
+static void _row_remove(_row_struct *row, long e, const ctx_t ctx)
+{
+    row->n--;
+    if (e != row->n)
+    {
+        row->j[e] = row->j[row->n];
+        ctx->swap(ctx, row->x + e * ctx->size, row->x + row->n * ctx->size);
+    }
+}
+
+static void _col_append(long **cl, long *cn, long *ca, long c, long r)
+{
+    if (cn[c] == ca[c])
+    {
+        ca[c] = FLINT_MAX(4, 2 * ca[c]);
+        cl[c] = realloc(cl[c], ca[c] * sizeof(long));
+        if (!cl[c])
+        {
+            printf("ERROR (_mat_csr_lu_sparse).  Memory allocation.\n\n");
+            abort();
+        }
+    }
+    cl[c][cn[c]++] = r;
+}
+
+int _mat_csr_lu_sparse(__mat_csr_lu_struct *F, long len, 
+                       const char *x, const long *j, 
+                       const long *p, const long *lenr, long off, 
+                       long budget, const ctx_t ctx)
+{
+    _row_struct *U, *L;
+    long **cl, *cn, *ca, *cc, *pos, *rp, *cq;
+    char *rdone, *l, *t;
+    long c, e, q, r, tot, step;
+    int fail = 0;
+
+    U = calloc(len, sizeof(_row_struct));
+    L = calloc(len, sizeof(_row_struct));
+    cl = calloc(len, sizeof(long *));
+    cn = calloc(len, sizeof(long));
+    ca = calloc(len, sizeof(long));
+    cc = calloc(len, sizeof(long));
+    pos = malloc(len * sizeof(long));
+    rp = malloc(len * sizeof(long));
+    cq = malloc(len * sizeof(long));
+    rdone = calloc(len, 1);
+
+    if (!U || !L || !cl || !cn || !ca || !cc || !pos || !rp || !cq
+           || !rdone)
+    {
+        printf("ERROR (_mat_csr_lu_sparse).  Memory allocation.\n\n");
+        abort();
+    }
+
+    l = _vec_init(1, ctx);
+    t = _vec_init(1, ctx);
+
+    /* Copy the rows of the block, with columns relative to off */
+    tot = 0;
+    for (r = 0; r < len; r++)
+    {
+        for (q = p[r]; q < p[r] + lenr[r]; q++)
+        {
+            c = j[q] - off;
+            if (0 <= c && c < len
+                && !ctx->is_zero(ctx, x + q * ctx->size))
+            {
+                _row_fit_length(U + r, U[r].n + 1, ctx);
+                U[r].j[U[r].n] = c;
+                ctx->set(ctx, U[r].x + U[r].n * ctx->size, x + q * ctx->size);
+                U[r].n++;
+                cc[c]++;
+                _col_append(cl, cn, ca, c, r);
+            }
+        }
+        tot += U[r].n;
+    }
+
+    for (c = 0; c < len; c++)
+        pos[c] = -1;
+
+    for (step = 0; step < len && !fail; step++)
+    {
+        long pr = -1, pe = -1, best = -1, nmin = -1, seen = 0;
+
+        /*
+            Markowitz pivot, minimising (r_i - 1)(c_j - 1) over the
+            entries of up to SEARCH active rows of least length
+         */
+        for (r = 0; r < len; r++)
+            if (!rdone[r] && (nmin < 0 || U[r].n < nmin))
+                nmin = U[r].n;
+
+        if (nmin <= 0)
+        {
+            fail = 1;
+            break;
+        }
+
+        for (r = 0; r < len && seen < SEARCH && best != 0; r++)
+        {
+            if (rdone[r] || U[r].n != nmin)
+                continue;
+
+            seen++;
+            for (e = 0; e < U[r].n; e++)
+            {
+                const long cost = (nmin - 1) * (cc[U[r].j[e]] - 1);
+
+                if (best < 0 || cost < best)
+                {
+                    best = cost;
+                    pr   = r;
+                    pe   = e;
+                }
+            }
+        }
+
+        rp[step] = pr;
+        cq[step] = U[pr].j[pe];
+        rdone[pr] = 1;
+
+        /* Move the pivot to the front of its row */
+        if (pe != 0)
+        {
+            c = U[pr].j[0];
+            U[pr].j[0]  = U[pr].j[pe];
+            U[pr].j[pe] = c;
+            ctx->swap(ctx, U[pr].x, U[pr].x + pe * ctx->size);
+        }
+
+        for (e = 0; e < U[pr].n; e++)
+            cc[U[pr].j[e]]--;
+
+        /* Eliminate the pivot column from the other active rows */
+        for (q = 0; q < cn[cq[step]] && !fail; q++)
+        {
+            long n0;
+
+            r = cl[cq[step]][q];
+            if (rdone[r])
+                continue;
+
+            for (e = 0; e < U[r].n && U[r].j[e] != cq[step]; e++) ;
+            if (e == U[r].n)
+                continue;
+
+            n0 = U[r].n;
+
+            /* Multiplier l, recorded as the entry (step, l) of L */
+            ctx->div(ctx, l, U[r].x + e * ctx->size, U[pr].x);
+            _row_fit_length(L + r, L[r].n + 1, ctx);
+            L[r].j[L[r].n] = step;
+            ctx->set(ctx, L[r].x + L[r].n * ctx->size, l);
+            L[r].n++;
+
+            _row_remove(U + r, e, ctx);
+
+            /* Row r -= l * row pr, scattering the positions of row r */
+            for (e = 0; e < U[r].n; e++)
+                pos[U[r].j[e]] = e;
+
+            for (e = 1; e < U[pr].n; e++)
+            {
+                c = U[pr].j[e];
+                ctx->mul(ctx, t, l, U[pr].x + e * ctx->size);
+
+                if (pos[c] >= 0)
+                {
+                    ctx->sub(ctx, U[r].x + pos[c] * ctx->size,
+                                  U[r].x + pos[c] * ctx->size, t);
+                }
+                else
+                {
+                    _row_fit_length(U + r, U[r].n + 1, ctx);
+                    pos[c] = U[r].n;
+                    U[r].j[U[r].n] = c;
+                    ctx->neg(ctx, U[r].x + U[r].n * ctx->size, t);
+                    U[r].n++;
+                    cc[c]++;
+                    _col_append(cl, cn, ca, c, r);
+                }
+            }
+
+            for (e = 0; e < U[r].n; e++)
+                pos[U[r].j[e]] = -1;
+
+            /* Remove cancelled entries */
+            for (e = U[r].n - 1; e >= 0; e--)
+                if (ctx->is_zero(ctx, U[r].x + e * ctx->size))
+                {
+                    cc[U[r].j[e]]--;
+                    _row_remove(U + r, e, ctx);
+                }
+
+            /* One entry of L, the change in U due to fill-in */
+            tot += 1 + (U[r].n - n0);
+
+            if (tot > budget)
+                fail = 1;
+        }
+    }
+
+    /* Write out the factors */
+    if (!fail)
+    {
+        long lenL = 0, lenU = 0;
+
+        for (r = 0; r < len; r++)
+        {
+            lenL += L[r].n;
+            lenU += U[r].n;
+        }
+
+        F->len = len;
+        F->rp  = rp;
+        F->cq  = cq;
+        F->Lp  = malloc((len + 1) * sizeof(long));
+        F->Lj  = malloc(FLINT_MAX(lenL, 1) * sizeof(long));
+        F->Lx  = (lenL > 0) ? _vec_init(lenL, ctx) : NULL;
+        F->Up  = malloc((len + 1) * sizeof(long));
+        F->Uj  = malloc(lenU * sizeof(long));
+        F->Ux  = _vec_init(lenU, ctx);
+
+        F->Lp[0] = 0;
+        F->Up[0] = 0;
+        for (step = 0; step < len; step++)
+        {
+            r = rp[step];
+
+            for (e = 0; e < L[r].n; e++)
+            {
+                F->Lj[F->Lp[step] + e] = L[r].j[e];
+                ctx->swap(ctx, F->Lx + (F->Lp[step] + e) * ctx->size,
+                               L[r].x + e * ctx->size);
+            }
+            F->Lp[step + 1] = F->Lp[step] + L[r].n;
+
+            for (e = 0; e < U[r].n; e++)
+            {
+                F->Uj[F->Up[step] + e] = U[r].j[e];
+                ctx->swap(ctx, F->Ux + (F->Up[step] + e) * ctx->size,
+                               U[r].x + e * ctx->size);
+            }
+            F->Up[step + 1] = F->Up[step] + U[r].n;
+        }
+    }
+    else
+    {
+        F->len = 0;
+        free(rp);
+        free(cq);
+    }
+
+    for (r = 0; r < len; r++)
+    {
+        _row_clear(U + r, ctx);
+        _row_clear(L + r, ctx);
+        free(cl[r]);
+    }
+    free(U);
+    free(L);
+    free(cl);
+    free(cn);
+    free(ca);
+    free(cc);
+    free(pos);
+    free(rdone);
+    _vec_clear(l, 1, ctx);
+    _vec_clear(t, 1, ctx);
+
+    return fail;
+}
+
@@ -0,0 +1,28 @@
+#include <stdlib.h>
+
+#include "vec.h"
+
+#include "mat_csr.h"
+
+void _mat_csr_lu_sparse_clear(__mat_csr_lu_struct *F, const ctx_t ctx)
+{
+    if (F->len > 0)
+    {
+        const long lenL = F->Lp[F->len];
+        const long lenU = F->Up[F->len];
+
+        if (lenL > 0)
+            _vec_clear(F->Lx, lenL, ctx);
+        _vec_clear(F->Ux, lenU, ctx);
+
+        free(F->rp);
+        free(F->cq);
+        free(F->Lp);
+        free(F->Lj);
+        free(F->Up);
+        free(F->Uj);
+
+        F->len = 0;
+    }
+}
+
@@ -0,0 +1,64 @@
+#include <assert.h>
+
+#include "vec.h"
+
+#include "mat_csr.h"
+
+void _mat_csr_lu_sparse_solve_mat(char *X, const __mat_csr_lu_struct *F, 
+                                  const char *B, long r, char *W, 
+                                  const ctx_t ctx)
+{
+    const long len = F->len;
+    const long w   = r * ctx->size;     /* Width of a row in bytes */
+
+    char *Z = W, *t = W + len * w;
+    long c, e, i;
+
+    assert(X != B);
+
+    /* Solve the unit lower triangular system L Z = P B */
+    for (i = 0; i < len; i++)
+    {
+        _vec_set(Z + i * w, B + F->rp[i] * w, r, ctx);
+
+        for (e = F->Lp[i]; e < F->Lp[i + 1]; e++)
+            for (c = 0; c < r; c++)
+            {
+                ctx->mul(ctx, t, F->Lx + e * ctx->size, 
+                                 Z + F->Lj[e] * w + c * ctx->size);
+                ctx->sub(ctx, Z + i * w + c * ctx->size, 
+                              Z + i * w + c * ctx->size, t);
+            }
+    }
+
+    /* Solve the upper triangular system U Q^t X = Z */
+    for (i = len - 1; i >= 0; i--)
+    {
+        char *x = X + F->cq[i] * w;
+
+        for (e = F->Up[i] + 1; e < F->Up[i + 1]; e++)
+            for (c = 0; c < r; c++)
+            {
+                ctx->mul(ctx, t, F->Ux + e * ctx->size, 
+                                 X + F->Uj[e] * w + c * ctx->size);
+                ctx->sub(ctx, Z + i * w + c * ctx->size, 
+                              Z + i * w + c * ctx->size, t);
+            }
+
+        for (c = 0; c < r; c++)
+            ctx->div(ctx, x + c * ctx->size, Z + i * w + c * ctx->size, 
+                          F->Ux + F->Up[i] * ctx->size);
+    }
+
+}
+
+void _mat_csr_lu_sparse_solve(char *x, const __mat_csr_lu_struct *F, 
+                              const char *b, const ctx_t ctx)
+{
+    char *W;
+
+    W = _vec_init(F->len + 1, ctx);
+    _mat_csr_lu_sparse_solve_mat(x, F, b, 1, W, ctx);
+    _vec_clear(W, F->len + 1, ctx);
+}
+
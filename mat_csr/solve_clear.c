@@ -4,19 +4,68 @@
 
 #include "mat_csr.h"
 
-void mat_csr_solve_clear(mat_csr_solve_t s, const ctx_t ctx)
+void _mat_csr_solve_clear_numeric(mat_csr_solve_t s, const ctx_t ctx)
 {
-    long k, len, sum = 0;
+    long i, k, len, lenx = 0, sum = 0;
 
     for (k = 0; k < s->nb; k++)
     {
         len  = s->B[k + 1] - s->B[k];
-        sum += len * len;
+        if (s->F[k].len > 0)
+            _mat_csr_lu_sparse_clear(s->F + k, ctx);
+        else
+            sum += len * len;
     }
 
-    _vec_clear(s->entries, sum, ctx);
+    if (s->ff)
+    {
+        for (i = 0; i < s->m; i++)
+            lenx = FLINT_MAX(lenx, s->p[i] + s->lenr[i]);
 
-    free(s->j);
-    free(s->LU);
+        for (i = 0; i < s->m; i++)
+            fmpz_poly_clear(s->rho + i);
+        for (i = 0; i < lenx; i++)
+            fmpz_poly_clear(s->xn + i);
+        for (k = 0; k < s->nb; k++)
+            fmpz_poly_mat_clear(s->ffLU + k);
+
+        free(s->rho);
+        free(s->xn);
+        free(s->ffLU);
+        free(s->blk);
+        free(s->fp);
+        free(s->fl);
+        s->rho  = NULL;
+        s->xn   = NULL;
+        s->ffLU = NULL;
+        s->blk  = NULL;
+        s->fp   = NULL;
+        s->fl   = NULL;
+    }
+    else
+    {
+        if (sum > 0)
+            _vec_clear(s->entries, sum, ctx);
+        s->entries = NULL;
+    }
+
+    free(s->F);
+    s->F = NULL;
 }
 
+void mat_csr_solve_clear(mat_csr_solve_t s, const ctx_t ctx)
+{
+    _mat_csr_solve_clear_numeric(s, ctx);
+
+    free(s->LU);
+    free(s->P);
+
+    if (s->ownx && s->A->alloc > 0)
+        _vec_clear(s->x, s->A->alloc, ctx);
+
+    if (s->own)
+    {
+        mat_csr_analysis_clear(s->A);
+        free(s->A);
+    }
+}
@@ -0,0 +1,332 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mat_csr.h"
+
+/*
+    Solves A X = B over Q(t) using the fraction-free data of a solve
+    structure initialised by mat_csr_solve_init_ff().
+
+    The solution in block k is kept as a matrix of numerators in Z[t]
+    over a single denominator e[k].  The right-hand side of block k
+    is brought to the common denominator E of the entries of B and
+    of the e[l] of the blocks l feeding into it, after which the
+    fraction-free forward and back substitution is exact in Z[t].
+    The only gcds are the lcms for E, one gcd per block to remove
+    common factors from e[k], and the canonicalisation of the output.
+
+    Blocks with a sparse factorisation F[k] are instead solved over
+    Q(t) from the right-hand side C / (E rho), and their solution is
+    then brought to the common denominator e[k] of its entries.
+
+    All polynomials are kept in the numerators of the elements of the 
+    workspace W, whose denominators are not touched, and the index of 
+    the blocks feeding into each block is part of the solve structure, 
+    so that nothing is allocated here.
+ */
+
+static __inline__ 
+fmpz_poly_struct * _num(char *W, long i, const ctx_t ctx)
+{
+    return ((fmpz_poly_q_struct *) (W + i * ctx->size))->num;
+}
+
+/*
+    Sets up the block of each row and the lists of the distinct blocks 
+    l < k feeding into each block k of the fraction-free solve structure s.
+ */
+void _mat_csr_solve_ff_index(mat_csr_solve_t s)
+{
+    long i, k, l, q, pass, len = 0;
+    long *mark;
+
+    s->blk = malloc(FLINT_MAX(s->m, 1) * sizeof(long));
+    s->fp  = malloc((s->nb + 1) * sizeof(long));
+    s->fl  = NULL;
+    mark   = malloc(FLINT_MAX(s->nb, 1) * sizeof(long));
+
+    if (!(s->blk) || !(s->fp) || !mark)
+    {
+        printf("ERROR (_mat_csr_solve_ff_index).  Memory allocation.\n\n");
+        abort();
+    }
+
+    for (k = 0; k < s->nb; k++)
+        for (i = s->B[k]; i < s->B[k + 1]; i++)
+            s->blk[i] = k;
+
+    /* Count the lists in the first pass, fill them in the second */
+    for (pass = 0; pass < 2; pass++)
+    {
+        if (pass == 1)
+        {
+            s->fl = malloc(FLINT_MAX(len, 1) * sizeof(long));
+            if (!(s->fl))
+            {
+                printf("ERROR (_mat_csr_solve_ff_index).  Memory allocation.\n\n");
+                abort();
+            }
+        }
+
+        len = 0;
+        for (k = 0; k < s->nb; k++)
+            mark[k] = -1;
+
+        for (k = 0; k < s->nb; k++)
+        {
+            s->fp[k] = len;
+            for (i = s->B[k]; i < s->B[k + 1]; i++)
+                for (q = s->p[i]; q < s->p[i] + s->lenr[i]; q++)
+                {
+                    l = s->blk[s->j[q]];
+                    if (l < k && mark[l] != k)
+                    {
+                        mark[l] = k;
+                        if (pass == 1)
+                            s->fl[len] = l;
+                        len++;
+                    }
+                }
+        }
+        s->fp[s->nb] = len;
+    }
+
+    free(mark);
+}
+
+/*
+    Sets column c of the len x r matrix of numerators Z to the solution 
+    of A{kk} Z = det C, for the block in FFLU form in LU with the row 
+    permutation P, by the fraction-free forward and back substitution 
+    of fmpz_poly_mat_solve_fflu_precomp(), using t as scratch.
+ */
+static void _mat_csr_solve_fflu_col(char *Z, const fmpz_poly_mat_t LU, 
+                                    const long *P, char *C, long c, long r, 
+                                    fmpz_poly_struct *t, const ctx_t ctx)
+{
+    const long n = LU->r;
+
+    long i, j;
+
+    for (i = 0; i < n; i++)
+        fmpz_poly_set(_num(Z, i * r + c, ctx), _num(C, P[i] * r + c, ctx));
+
+    for (i = 0; i < n - 1; i++)
+    {
+        for (j = i + 1; j < n; j++)
+        {
+            fmpz_poly_struct *Zj = _num(Z, j * r + c, ctx);
+
+            fmpz_poly_mul(Zj, Zj, fmpz_poly_mat_entry(LU, i, i));
+            fmpz_poly_mul(t, fmpz_poly_mat_entry(LU, j, i), 
+                             _num(Z, i * r + c, ctx));
+            fmpz_poly_sub(Zj, Zj, t);
+            if (i > 0)
+                fmpz_poly_div(Zj, Zj, fmpz_poly_mat_entry(LU, i - 1, i - 1));
+        }
+    }
+
+    for (i = n - 2; i >= 0; i--)
+    {
+        fmpz_poly_struct *Zi = _num(Z, i * r + c, ctx);
+
+        fmpz_poly_mul(Zi, Zi, fmpz_poly_mat_entry(LU, n - 1, n - 1));
+        for (j = i + 1; j < n; j++)
+        {
+            fmpz_poly_mul(t, _num(Z, j * r + c, ctx), 
+                             fmpz_poly_mat_entry(LU, i, j));
+            fmpz_poly_sub(Zi, Zi, t);
+        }
+        fmpz_poly_div(Zi, Zi, fmpz_poly_mat_entry(LU, i, i));
+    }
+}
+
+long _mat_csr_solve_ff_worklen(const mat_csr_solve_t s, long r)
+{
+    long k, lenB = 0, lenZ = 0;
+
+    for (k = 0; k < s->nb; k++)
+    {
+        lenB = FLINT_MAX(lenB, s->B[k + 1] - s->B[k]);
+        lenZ = FLINT_MAX(lenZ, s->F[k].len);
+    }
+
+    return s->m * r + 2 * s->nb + 3 + 2 * lenB * r 
+           + (lenZ > 0 ? 3 * lenZ * r + 1 : 0);
+}
+
+void _mat_csr_solve_ff(char *X, const mat_csr_solve_t s, const char *B,
+                       long r, char *W, const ctx_t ctx)
+{
+    const long m = s->m;
+
+    char *Y;    /* Numerators of the solution, m x r */
+    char *e;    /* Denominators of the blocks of Y */
+    char *h;    /* E / e[l] for the blocks l feeding into k */
+    char *C, *Z, *V;
+    fmpz_poly_struct *E, *g, *t;
+    long lenB = 0;
+    long c, i, j, k, l, q;
+
+    assert(s->ff);
+    assert(s->m == s->n);
+    assert(r > 0);
+
+    for (k = 0; k < s->nb; k++)
+        lenB = FLINT_MAX(lenB, s->B[k + 1] - s->B[k]);
+
+    Y = W;
+    e = Y + m * r * ctx->size;
+    h = e + s->nb * ctx->size;
+    E = _num(h, s->nb, ctx);
+    g = _num(h, s->nb + 1, ctx);
+    t = _num(h, s->nb + 2, ctx);
+    C = h + (s->nb + 3) * ctx->size;
+    Z = C + lenB * r * ctx->size;
+    V = Z + lenB * r * ctx->size;
+
+    for (k = 0; k < s->nb; k++)
+    {
+        const long i1  = s->B[k];
+        const long i2  = s->B[k + 1];
+        const long len = i2 - i1;
+
+        fmpz_poly_struct *ek = _num(e, k, ctx);
+
+        /* Common denominator E of the right-hand side of block k */
+        fmpz_poly_one(E);
+        for (i = i1; i < i2; i++)
+            for (c = 0; c < r; c++)
+            {
+                const fmpz_poly_q_struct *b =
+                    (const fmpz_poly_q_struct *) (B + (s->pi[i] * r + c) * ctx->size);
+
+                if (!fmpz_poly_is_one(b->den))
+                    fmpz_poly_lcm(E, E, b->den);
+            }
+        for (q = s->fp[k]; q < s->fp[k + 1]; q++)
+        {
+            l = s->fl[q];
+            if (!fmpz_poly_is_one(_num(e, l, ctx)))
+                fmpz_poly_lcm(E, E, _num(e, l, ctx));
+        }
+        for (q = s->fp[k]; q < s->fp[k + 1]; q++)
+        {
+            l = s->fl[q];
+            fmpz_poly_div(_num(h, l, ctx), E, _num(e, l, ctx));
+        }
+
+        /* Integral right-hand side C = E (rho b - A{kl} x{l}) */
+        for (i = i1; i < i2; i++)
+        {
+            for (c = 0; c < r; c++)
+            {
+                const fmpz_poly_q_struct *b =
+                    (const fmpz_poly_q_struct *) (B + (s->pi[i] * r + c) * ctx->size);
+
+                fmpz_poly_div(t, E, b->den);
+                fmpz_poly_mul(t, t, b->num);
+                fmpz_poly_mul(_num(C, (i - i1) * r + c, ctx), t, s->rho + i);
+            }
+            for (q = s->p[i]; q < s->p[i] + s->lenr[i]; q++)
+            {
+                j = s->j[q];
+                l = s->blk[j];
+                if (l >= k)
+                    continue;
+
+                fmpz_poly_mul(g, s->xn + q, _num(h, l, ctx));
+                for (c = 0; c < r; c++)
+                {
+                    fmpz_poly_struct *Cic = _num(C, (i - i1) * r + c, ctx);
+
+                    fmpz_poly_mul(t, g, _num(Y, j * r + c, ctx));
+                    fmpz_poly_sub(Cic, Cic, t);
+                }
+            }
+        }
+
+        if (s->F[k].len > 0)
+        {
+            /*
+                A sparse block, factored over Q(t):  solve for x{k} from 
+                the right-hand side C / (E rho) and bring the solution to 
+                the common denominator e[k] of its entries
+             */
+            char *U = V + len * r * ctx->size;
+
+            for (i = 0; i < len; i++)
+                for (c = 0; c < r; c++)
+                {
+                    fmpz_poly_q_struct *v =
+                        (fmpz_poly_q_struct *) (V + (i * r + c) * ctx->size);
+
+                    fmpz_poly_set(v->num, _num(C, i * r + c, ctx));
+                    fmpz_poly_mul(v->den, E, s->rho + (i1 + i));
+                    fmpz_poly_q_canonicalise(v);
+                }
+
+            _mat_csr_lu_sparse_solve_mat(U, s->F + k, V, r, 
+                                         U + len * r * ctx->size, ctx);
+
+            fmpz_poly_one(ek);
+            for (i = 0; i < len * r; i++)
+            {
+                const fmpz_poly_q_struct *x =
+                    (const fmpz_poly_q_struct *) (U + i * ctx->size);
+
+                if (!fmpz_poly_is_one(x->den))
+                    fmpz_poly_lcm(ek, ek, x->den);
+            }
+            for (i = 0; i < len * r; i++)
+            {
+                const fmpz_poly_q_struct *x =
+                    (const fmpz_poly_q_struct *) (U + i * ctx->size);
+
+                fmpz_poly_div(t, ek, x->den);
+                fmpz_poly_mul(_num(Z, i, ctx), x->num, t);
+            }
+        }
+        else
+        {
+            /* Now A{kk} Z = det C, so that x{k} = Z / (det E) */
+            for (c = 0; c < r; c++)
+                _mat_csr_solve_fflu_col(Z, s->ffLU + k, s->P + i1, C, c, r, 
+                                        t, ctx);
+            fmpz_poly_mul(ek, E,
+                          fmpz_poly_mat_entry(s->ffLU + k, len - 1, len - 1));
+        }
+
+        /* Remove common factors of the numerators and e[k] */
+        fmpz_poly_set(g, ek);
+        for (i = 0; i < len * r && !fmpz_poly_is_unit(g); i++)
+            fmpz_poly_gcd(g, g, _num(Z, i, ctx));
+
+        if (!fmpz_poly_is_unit(g))
+        {
+            fmpz_poly_div(ek, ek, g);
+            for (i = 0; i < len * r; i++)
+                fmpz_poly_div(_num(Z, i, ctx), _num(Z, i, ctx), g);
+        }
+
+        for (i = 0; i < len * r; i++)
+            fmpz_poly_swap(_num(Y, i1 * r + i, ctx), _num(Z, i, ctx));
+    }
+
+    /* Write out Q^{-1} X, forming the reduced fractions */
+    for (i = 0; i < m; i++)
+    {
+        j = s->qi[i];
+
+        for (c = 0; c < r; c++)
+        {
+            fmpz_poly_q_struct *x =
+                (fmpz_poly_q_struct *) (X + (i * r + c) * ctx->size);
+
+            fmpz_poly_set(x->num, _num(Y, j * r + c, ctx));
+            fmpz_poly_set(x->den, _num(e, s->blk[j], ctx));
+            fmpz_poly_q_canonicalise(x);
+        }
+    }
+}
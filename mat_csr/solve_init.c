@@ -1,115 +1,202 @@
 #include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
 
+#include "flint/flint.h"
+
+#include "flint_ex.h"
 #include "vec.h"
 
 #include "mat_csr.h"
 
 #define DEBUG  0
 
-void mat_csr_solve_init(mat_csr_solve_t s, const mat_csr_t mat, 
-                        const ctx_t ctx)
+/*
+    The diagonal blocks are decomposed independently of each other. 
+    Each thread claims the next block from the array order, which lists 
+    num pairs (len, k) sorted by decreasing block length len.  If sparse 
+    is non-zero, the blocks are factored sparsely where possible, and 
+    otherwise by the dense kernels.
+ */
+typedef struct
 {
-    long *w;
-    long *mem;
-    long i, k, m, nz;
-
-    assert(mat->m == mat->n);
+    __mat_csr_solve_struct *s;
+    const long *order;
+    long num;
+    int sparse;
+    long *next;
+    int *fail;
+    pthread_mutex_t *mutex;
+    const __ctx_struct *ctx;
+} _mat_csr_lup_arg_struct;
+
+static int _mat_csr_block_cmp(const void *a, const void *b)
+{
+    const long x = *(const long *) a, y = *(const long *) b;
 
-    m = mat->m;
+    return (x > y) ? -1 : ((x < y) ? 1 : 0);
+}
 
-    #if (DEBUG > 0)
-    printf("mat_csr_solve_init()\n");
-    printf("Matrix A (%ld x %ld):\n", mat->m, mat->n);
-    mat_csr_print_dense(mat, ctx);
-    printf("\n");
-    fflush(stdout);
-    #endif
+static void * _mat_csr_lup_worker(void *arg_ptr)
+{
+    const _mat_csr_lup_arg_struct *arg = arg_ptr;
+    __mat_csr_solve_struct *s = arg->s;
+    long i, k, len;
+    fmpz_poly_t den;
 
-    mem   = malloc((mat->alloc + 6 * m + 1) * sizeof(long));
-    s->LU = malloc(m * sizeof(char *));
-    w     = malloc((3 * m) * sizeof(long));
+    fmpz_poly_init(den);
 
-    if (!mem || !(s->LU) || !w)
+    while (1)
     {
-        printf("ERROR (mat_csr_solve_init).  Memory allocation.\n\n");
-        abort();
+        pthread_mutex_lock(arg->mutex);
+        i = (*arg->next)++;
+        pthread_mutex_unlock(arg->mutex);
+
+        if (i >= arg->num)
+            break;
+
+        len = arg->order[2 * i];
+        k   = arg->order[2 * i + 1];
+
+        #if (DEBUG > 0)
+        printf("  Block %ld out of %ld, of size %ld\n", k, s->nb, len);
+        fflush(stdout);
+        #endif
+
+        if (arg->sparse)
+        {
+            const long i1 = s->B[k];
+
+            _mat_csr_lu_sparse(s->F + k, len, s->x, s->j, s->p + i1, 
+                               s->lenr + i1, i1, 
+                               len * len / MAT_CSR_LU_SPARSE_FILL, arg->ctx);
+        }
+        else if (s->ff ? (fmpz_poly_mat_fflu(s->ffLU + k, den, 
+                                             s->P + s->B[k], s->ffLU + k, 1) < len)
+                       : _mat_lup_decompose(s->P + s->B[k], s->LU + s->B[k], 
+                                            len, arg->ctx))
+        {
+            pthread_mutex_lock(arg->mutex);
+            *(arg->fail) = 1;
+            pthread_mutex_unlock(arg->mutex);
+        }
     }
 
-    s->j    = mem;
-    s->p    = mem + mat->alloc;
-    s->lenr = mem + mat->alloc + m;
-    s->pi   = mem + mat->alloc + 2 * m;
-    s->qi   = mem + mat->alloc + 3 * m;
-    s->P    = mem + mat->alloc + 4 * m;
-    s->B    = mem + mat->alloc + 5 * m;
+    fmpz_poly_clear(den);
 
-    #if (DEBUG > 0)
-    printf("Calling mat_csr_zfdiagonal()\n");
-    fflush(stdout);
-    #endif
+    return NULL;
+}
 
-    nz = mat_csr_zfdiagonal(s->pi, mat);
+/*
+    Decomposes the diagonal blocks of s over up to 
+    flint_parallel_num_threads() threads, in order of decreasing size.  If sparse is non-zero, only 
+    tries the sparse factorisation of the blocks of length at least 
+    MAT_CSR_LU_SPARSE_MIN, and otherwise decomposes the blocks without 
+    a sparse factorisation with the dense kernels.
+
+    Returns $1$ if one of the blocks is singular, and $0$ otherwise.
+ */
+static int _mat_csr_solve_blocks(mat_csr_solve_t s, int sparse, 
+                                 const ctx_t ctx)
+{
+    _mat_csr_lup_arg_struct *args;
+    pthread_mutex_t mutex;
+    long *order, num, next, k, t, nt;
+    int fail = 0;
+
+    /* Process the blocks in order of decreasing size */
+    order = malloc(2 * s->nb * sizeof(long));
+    for (k = 0, num = 0; k < s->nb; k++)
+    {
+        const long lenk = s->B[k + 1] - s->B[k];
 
-    #if (DEBUG > 0)
-    printf("nz = %ld\n", nz);
-    printf("pi = {"); _perm_print(s->pi, m); printf("}\n");
-    fflush(stdout);
-    #endif
+        if (sparse ? (lenk >= MAT_CSR_LU_SPARSE_MIN) : (s->F[k].len == 0))
+        {
+            order[2 * num]     = lenk;
+            order[2 * num + 1] = k;
+            num++;
+        }
+    }
+    qsort(order, num, 2 * sizeof(long), _mat_csr_block_cmp);
+
+    /* Blocks of length at most 2 are not worth a thread */
+    for (nt = 0; nt < num && order[2 * nt] > 2; nt++) ;
+    nt = FLINT_MAX(1, FLINT_MIN(flint_parallel_num_threads(), nt));
 
-    if (nz != m)
+    args = malloc(nt * sizeof(_mat_csr_lup_arg_struct));
+
+    pthread_mutex_init(&mutex, NULL);
+    next = 0;
+
+    for (t = 0; t < nt; t++)
     {
-        printf("ERROR (mat_csr_solve_init).  Singular matrix.\n\n");
-        abort();
+        args[t].s      = s;
+        args[t].order  = order;
+        args[t].num    = num;
+        args[t].sparse = sparse;
+        args[t].next   = &next;
+        args[t].fail   = &fail;
+        args[t].mutex  = &mutex;
+        args[t].ctx    = ctx;
     }
 
-    /* Copy the sparse structure of mat into {j, p, lenr} */
+    flint_parallel_run(_mat_csr_lup_worker, args, 
+                       sizeof(_mat_csr_lup_arg_struct), nt);
 
-    s->m = mat->m;
-    s->n = mat->n;
-    s->x = mat->x;
+    pthread_mutex_destroy(&mutex);
+    free(args);
+    free(order);
 
-    for (i = 0; i < m; i++)
-        s->lenr[i] = mat->lenr[i];
-    for (i = 0; i < m; i++)
-        s->p[i] = mat->p[i];
-    for (i = 0; i < mat->alloc; i++)
-        s->j[i] = mat->j[i];
+    return fail;
+}
 
-    /* Set A := P A */
-    _mat_csr_permute_rows(m, s->p, s->lenr, s->pi);
+/*
+    Sets up the numerical data of the solve structure s, for which the 
+    sparse structure and the permutations have already been set up, 
+    from the values s->x, and decomposes the diagonal blocks.
+ */
+static int _mat_csr_solve_numeric(mat_csr_solve_t s, const ctx_t ctx)
+{
+    const long m = s->m;
+    const int ff = s->ff;
 
-    /* Find Q s.t. Q P A Q^t is block triangular */
-    s->nb = _mat_csr_block_triangularise(s->qi, s->B, m, s->j, s->p, s->lenr, w);
-    s->B[s->nb] = m;
+    long i, k;
+    int fail = 0;
 
-    _mat_csr_permute_rows(m, s->p, s->lenr, s->qi);
+    s->F = calloc(s->nb, sizeof(__mat_csr_lu_struct));
 
-    _mat_csr_permute_cols(m, m, s->j, s->p, s->lenr, s->qi);
+    /*
+        Sparse factorisation of large blocks, over the context itself 
+        also in the fraction-free case, where a dense FFLU of such a 
+        block would need all len^2 entries in Z[t]
+     */
+    {
+        #if (DEBUG > 0)
+        printf("Sparse LU decomposition for large blocks..\n");
+        fflush(stdout);
+        #endif
 
-    #if (DEBUG > 0)
-    printf("nb = %ld\n", s->nb);
-    printf("B  = {"); _perm_print(s->B, s->nb); printf("}\n");
-    printf("qi = {"); _perm_print(s->qi, m); printf("}\n");
-    printf("Matrix Q P A Q^t:\n");
-    _mat_csr_print_dense(m, m, s->x, s->j, s->p, s->lenr, ctx);
-    printf("\n");
-    fflush(stdout);
-    #endif
+        _mat_csr_solve_blocks(s, 1, ctx);
+    }
 
     /* Allocate dense data blocks */
+    if (!ff)
     {
         long len, sum = 0;
 
         for (k = 0; k < s->nb; k++)
         {
             len  = s->B[k + 1] - s->B[k];
-            sum += len * len;
+            if (s->F[k].len == 0)
+                sum += len * len;
         }
 
-        s->entries = _vec_init(sum, ctx);
+        s->entries = (sum > 0) ? _vec_init(sum, ctx) : NULL;
     }
 
     /* Copy data of the square blocks */
+    if (!ff)
     {
         char *off = s->entries;
 
@@ -119,6 +206,9 @@ void mat_csr_solve_init(mat_csr_solve_t s, const mat_csr_t mat,
             long len = s->B[k + 1] - s->B[k];
             long q, r;
 
+            if (s->F[k].len > 0)
+                continue;
+
             for (r = 0; r < len; r++)
                 rows[r] = off + r * len * ctx->size;
 
@@ -135,6 +225,82 @@ void mat_csr_solve_init(mat_csr_solve_t s, const mat_csr_t mat,
         }
     }
 
+    /* Fraction-free data over Z[t] */
+    if (ff)
+    {
+        fmpz_poly_t t;
+        long len, lenx = 0;
+
+        /* Scale each row by the lcm of its denominators */
+        for (i = 0; i < m; i++)
+            lenx = FLINT_MAX(lenx, s->p[i] + s->lenr[i]);
+
+        s->rho = malloc(m * sizeof(fmpz_poly_struct));
+        s->xn  = malloc(FLINT_MAX(lenx, 1) * sizeof(fmpz_poly_struct));
+        for (i = 0; i < m; i++)
+            fmpz_poly_init(s->rho + i);
+        for (i = 0; i < lenx; i++)
+            fmpz_poly_init(s->xn + i);
+
+        fmpz_poly_init(t);
+        for (i = 0; i < m; i++)
+        {
+            long q;
+
+            fmpz_poly_one(s->rho + i);
+            for (q = s->p[i]; q < s->p[i] + s->lenr[i]; q++)
+            {
+                const fmpz_poly_q_struct *a = 
+                    (const fmpz_poly_q_struct *) (s->x + q * ctx->size);
+
+                if (!fmpz_poly_is_one(a->den))
+                    fmpz_poly_lcm(s->rho + i, s->rho + i, a->den);
+            }
+            for (q = s->p[i]; q < s->p[i] + s->lenr[i]; q++)
+            {
+                const fmpz_poly_q_struct *a = 
+                    (const fmpz_poly_q_struct *) (s->x + q * ctx->size);
+
+                fmpz_poly_div(t, s->rho + i, a->den);
+                fmpz_poly_mul(s->xn + q, a->num, t);
+            }
+        }
+        fmpz_poly_clear(t);
+
+        _mat_csr_solve_ff_index(s);
+
+        /* Copy the integral data of the blocks without sparse factors */
+        s->ffLU = malloc(s->nb * sizeof(fmpz_poly_mat_struct));
+
+        for (k = 0; k < s->nb; k++)
+        {
+            long q, r;
+
+            if (s->F[k].len > 0)
+            {
+                fmpz_poly_mat_init(s->ffLU + k, 0, 0);
+                continue;
+            }
+
+            len = s->B[k + 1] - s->B[k];
+            fmpz_poly_mat_init(s->ffLU + k, len, len);
+
+            for (r = 0, i = s->B[k]; r < len; r++, i++)
+            {
+                s->P[i] = r;
+
+                for (q = s->p[i]; q < s->p[i] + s->lenr[i]; q++)
+                {
+                    long c = s->j[q] - s->B[k];
+
+                    if (0 <= c && c < len)
+                        fmpz_poly_set(fmpz_poly_mat_entry(s->ffLU + k, r, c), 
+                                      s->xn + q);
+                }
+            }
+        }
+    }
+
     /* Dense LUP decomposition */
 
     #if (DEBUG > 0)
@@ -142,24 +308,16 @@ void mat_csr_solve_init(mat_csr_solve_t s, const mat_csr_t mat,
     fflush(stdout);
     #endif
 
-    for (k = 0; k < s->nb; k++)
-    {
-        char **rows = s->LU + s->B[k];
-        long len = s->B[k + 1] - s->B[k];
-
-        #if (DEBUG > 0)
-        printf("  Block %ld out of %ld, of size %ld\n", k, s->nb, len);
-        fflush(stdout);
-        #endif
-
-        _mat_lup_decompose(s->P + s->B[k], rows, len, ctx);
-    }
+    fail = _mat_csr_solve_blocks(s, 0, ctx);
 
     #if (DEBUG > 0)
-    for (k = 0; k < s->nb; k++)
+    for (k = 0; !ff && k < s->nb; k++)
     {
         long len = s->B[k + 1] - s->B[k];
 
+        if (s->F[k].len > 0)
+            continue;
+
         printf("Block %ld (of length %ld):\n", k, len);
         _mat_print(s->LU + s->B[k], len, len, ctx);
         printf("\n");
@@ -167,15 +325,121 @@ void mat_csr_solve_init(mat_csr_solve_t s, const mat_csr_t mat,
     }
     #endif
 
-    /* Compose Q P, invert Q */
+    return fail;
+}
+
+/*
+    Sets up the solve structure s for the matrix mat from the analysis 
+    A of its sparsity pattern, which s takes over if own is non-zero, 
+    and decomposes the diagonal blocks.
+ */
+static int _mat_csr_solve_init(mat_csr_solve_t s, 
+                               __mat_csr_analysis_struct *A, int own, 
+                               const mat_csr_t mat, int ff, const ctx_t ctx)
+{
+    const long m = A->m;
+
+    assert(mat->m == A->m && mat->n == A->n);
+
+    #if (DEBUG > 0)
+    printf("mat_csr_solve_init()\n");
+    printf("Matrix A (%ld x %ld):\n", mat->m, mat->n);
+    mat_csr_print_dense(mat, ctx);
+    printf("\n");
+    fflush(stdout);
+    #endif
+
+    s->LU = malloc(m * sizeof(char *));
+    s->P  = malloc(m * sizeof(long));
+
+    if (!(s->LU) || !(s->P))
+    {
+        printf("ERROR (mat_csr_solve_init).  Memory allocation.\n\n");
+        abort();
+    }
+
+    /* Refer to the pattern in the analysis, and to the values of mat */
+
+    s->A    = A;
+    s->own  = own;
+    s->ownx = 0;
+
+    s->m    = A->m;
+    s->n    = A->n;
+    s->x    = mat->x;
+    s->j    = A->j;
+    s->p    = A->p;
+    s->lenr = A->lenr;
+    s->pi   = A->pi;
+    s->qi   = A->qi;
+    s->B    = A->B;
+    s->nb   = A->nb;
+    s->cp   = A->cp;
+    s->ci   = A->ci;
+    s->cq   = A->cq;
+    s->ff   = ff;
+
+    s->entries = NULL;
+    s->F       = NULL;
+    s->rho     = NULL;
+    s->xn      = NULL;
+    s->ffLU    = NULL;
+    s->blk     = NULL;
+    s->fp      = NULL;
+    s->fl      = NULL;
+
+    return _mat_csr_solve_numeric(s, ctx);
+}
+
+int mat_csr_solve_init(mat_csr_solve_t s, const mat_csr_t mat, 
+                       const ctx_t ctx)
+{
+    __mat_csr_analysis_struct *A = malloc(sizeof(__mat_csr_analysis_struct));
+
+    mat_csr_analysis_init(A, mat);
+    return _mat_csr_solve_init(s, A, 1, mat, 0, ctx);
+}
+
+int mat_csr_solve_init_ff(mat_csr_solve_t s, const mat_csr_t mat, 
+                          const ctx_t ctx)
+{
+    __mat_csr_analysis_struct *A = malloc(sizeof(__mat_csr_analysis_struct));
+
+    mat_csr_analysis_init(A, mat);
+    return _mat_csr_solve_init(s, A, 1, mat, 1, ctx);
+}
+
+int mat_csr_solve_init_analysis(mat_csr_solve_t s, 
+                                const mat_csr_analysis_t A, 
+                                const mat_csr_t mat, const ctx_t ctx)
+{
+    return _mat_csr_solve_init(s, (__mat_csr_analysis_struct *) A, 0, 
+                               mat, 0, ctx);
+}
+
+int mat_csr_solve_init_analysis_ff(mat_csr_solve_t s, 
+                                   const mat_csr_analysis_t A, 
+                                   const mat_csr_t mat, const ctx_t ctx)
+{
+    return _mat_csr_solve_init(s, (__mat_csr_analysis_struct *) A, 0, 
+                               mat, 1, ctx);
+}
 
-    _perm_compose(w, s->pi, s->qi, m);
-    _perm_set(s->pi, w, m);
+int mat_csr_solve_refactor(mat_csr_solve_t s, const mat_csr_t mat, 
+                           const ctx_t ctx)
+{
+    assert(mat->m == s->m && mat->n == s->n);
 
-    _perm_inv(s->qi, s->qi, m);
+    _mat_csr_solve_clear_numeric(s, ctx);
 
-    /* Clean-up temporary space */
+    if (s->ownx)
+    {
+        if (s->A->alloc > 0)
+            _vec_clear(s->x, s->A->alloc, ctx);
+        s->ownx = 0;
+    }
+    s->x = mat->x;
 
-    free(w);
+    return _mat_csr_solve_numeric(s, ctx);
 }
 
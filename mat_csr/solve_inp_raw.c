@@ -0,0 +1,449 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "flint/flint.h"
+
+#include "vec.h"
+
+#include "mat_csr.h"
+
+static int _read_longs(long *a, long n, FILE *file)
+{
+    return (n == 0) || (fread(a, sizeof(long), n, file) == (size_t) n);
+}
+
+static int _read_elems(char *x, long n, FILE *file, const ctx_t ctx)
+{
+    long i;
+    int ok = 1;
+
+    for (i = 0; ok && i < n; i++)
+        ok = ctx->inp_raw(ctx, x + i * ctx->size, file);
+    return ok;
+}
+
+/* Returns whether all n entries of a lie in [lo, hi) */
+static int _in_range(const long *a, long n, long lo, long hi)
+{
+    long i;
+
+    for (i = 0; i < n; i++)
+        if (a[i] < lo || a[i] >= hi)
+            return 0;
+    return 1;
+}
+
+/* Returns whether a[0] == 0, a is non-decreasing and a[n] <= hi */
+static int _is_pointers(const long *a, long n, long hi)
+{
+    long i;
+
+    if (a[0] != 0 || a[n] > hi)
+        return 0;
+    for (i = 0; i < n; i++)
+        if (a[i] > a[i + 1])
+            return 0;
+    return 1;
+}
+
+/* Returns whether a is a permutation of 0, ..., n - 1, using w of length n */
+static int _is_perm(const long *a, long n, long *w)
+{
+    long i;
+
+    if (!_in_range(a, n, 0, n))
+        return 0;
+    for (i = 0; i < n; i++)
+        w[i] = 0;
+    for (i = 0; i < n; i++)
+        if (w[a[i]]++)
+            return 0;
+    return 1;
+}
+
+/*
+    Reads the analysis of an m x m matrix with lenx stored entries and 
+    nb diagonal blocks, checking that all indices are in range. 
+    Returns the analysis, or NULL on failure.
+ */
+static __mat_csr_analysis_struct * 
+_read_analysis(FILE *file, long m, long lenx, long nb)
+{
+    __mat_csr_analysis_struct *A;
+    long i, k, *w;
+    int ok;
+
+    A = malloc(sizeof(__mat_csr_analysis_struct));
+    if (!A)
+        return NULL;
+
+    A->m     = m;
+    A->n     = m;
+    A->alloc = lenx;
+    A->nb    = nb;
+    A->j     = malloc((lenx + 5 * m + 1) * sizeof(long));
+    A->cp    = malloc((nb + 1) * sizeof(long));
+    A->ci    = NULL;
+
+    w  = malloc(m * sizeof(long));
+    ok = A->j && A->cp && w;
+
+    if (ok)
+    {
+        A->p    = A->j + lenx;
+        A->lenr = A->j + lenx + m;
+        A->pi   = A->j + lenx + 2 * m;
+        A->qi   = A->j + lenx + 3 * m;
+        A->B    = A->j + lenx + 4 * m;
+
+        ok = _read_longs(A->j, lenx, file)
+          && _read_longs(A->p, m, file)
+          && _read_longs(A->lenr, m, file)
+          && _read_longs(A->pi, m, file)
+          && _read_longs(A->qi, m, file)
+          && _read_longs(A->B, nb + 1, file)
+          && _read_longs(A->cp, nb + 1, file)
+          && _is_perm(A->pi, m, w) && _is_perm(A->qi, m, w)
+          && _is_pointers(A->B, nb, m) && A->B[nb] == m
+          && _is_pointers(A->cp, nb, lenx);
+    }
+
+    for (i = 0; ok && i < m; i++)
+        ok = A->p[i] >= 0 && A->lenr[i] >= 0 && A->p[i] <= lenx - A->lenr[i]
+          && _in_range(A->j + A->p[i], A->lenr[i], 0, m);
+    for (k = 0; ok && k < nb; k++)
+        ok = (A->B[k] < A->B[k + 1]);
+
+    if (ok)
+    {
+        A->ci = malloc(FLINT_MAX(2 * A->cp[nb], 1) * sizeof(long));
+        A->cq = A->ci + A->cp[nb];
+
+        ok = A->ci
+          && _read_longs(A->ci, A->cp[nb], file)
+          && _read_longs(A->cq, A->cp[nb], file)
+          && _in_range(A->ci, A->cp[nb], 0, m)
+          && _in_range(A->cq, A->cp[nb], 0, lenx);
+    }
+
+    free(w);
+
+    if (!ok)
+    {
+        mat_csr_analysis_clear(A);
+        free(A);
+        A = NULL;
+    }
+
+    return A;
+}
+
+/*
+    Reads the sparse factorisation F of a block of length len, checking 
+    that all indices are in range.  On failure, either F->len is zero 
+    and nothing is allocated, or F is complete and has to be cleared.
+ */
+static int _read_lu_sparse(__mat_csr_lu_struct *F, long len, FILE *file, 
+                           const ctx_t ctx)
+{
+    const long hi = (len > (LONG_MAX / 16) / len) ? LONG_MAX / 16 : len * len;
+
+    long t, *rp, *cq, *Lp, *Up, *Lj = NULL, *Uj = NULL, *w;
+    int ok;
+
+    rp = malloc(len * sizeof(long));
+    cq = malloc(len * sizeof(long));
+    Lp = malloc((len + 1) * sizeof(long));
+    Up = malloc((len + 1) * sizeof(long));
+    w  = malloc(len * sizeof(long));
+
+    ok = rp && cq && Lp && Up && w 
+      && _read_longs(rp, len, file)
+      && _read_longs(cq, len, file)
+      && _read_longs(Lp, len + 1, file)
+      && _read_longs(Up, len + 1, file)
+      && _is_perm(rp, len, w) && _is_perm(cq, len, w)
+      && _is_pointers(Lp, len, hi) && _is_pointers(Up, len, hi);
+
+    /* Every row of U starts with its pivot */
+    for (t = 0; ok && t < len; t++)
+        ok = (Up[t] < Up[t + 1]);
+
+    if (ok)
+    {
+        Lj = malloc(FLINT_MAX(Lp[len], 1) * sizeof(long));
+        Uj = malloc(Up[len] * sizeof(long));
+        ok = Lj && Uj;
+    }
+
+    free(w);
+
+    if (!ok)
+    {
+        free(rp);
+        free(cq);
+        free(Lp);
+        free(Up);
+        free(Lj);
+        free(Uj);
+        return 0;
+    }
+
+    F->rp  = rp;
+    F->cq  = cq;
+    F->Lp  = Lp;
+    F->Up  = Up;
+    F->Lj  = Lj;
+    F->Uj  = Uj;
+    F->Lx  = (Lp[len] > 0) ? _vec_init(Lp[len], ctx) : NULL;
+    F->Ux  = _vec_init(Up[len], ctx);
+    F->len = len;
+
+    ok = _read_longs(Lj, Lp[len], file)
+      && _read_longs(Uj, Up[len], file)
+      && _in_range(Uj, Up[len], 0, len);
+
+    /* Row t of L only has entries in the columns before t */
+    for (t = 0; ok && t < len; t++)
+        ok = _in_range(Lj + Lp[t], Lp[t + 1] - Lp[t], 0, t);
+
+    ok = ok && _read_elems(F->Lx, Lp[len], file, ctx)
+            && _read_elems(F->Ux, Up[len], file, ctx);
+
+    for (t = 0; ok && t < len; t++)
+        ok = !ctx->is_zero(ctx, F->Ux + Up[t] * ctx->size);
+
+    return ok;
+}
+
+/*
+    Clears the structure s after a failure while reading its numerical 
+    data, where the blocks with kind[k] zero have dense data and the 
+    others have a sparse factorisation if F[k].len is non-zero.
+ */
+static void _mat_csr_solve_inp_clear(mat_csr_solve_t s, const long *kind, 
+                                     const ctx_t ctx)
+{
+    const long lenx = s->A->alloc;
+
+    long i, k, len, sum = 0;
+
+    for (k = 0; k < s->nb; k++)
+    {
+        len = s->B[k + 1] - s->B[k];
+        if (kind[k])
+            _mat_csr_lu_sparse_clear(s->F + k, ctx);
+        else
+            sum += len * len;
+    }
+
+    if (s->ff)
+    {
+        for (i = 0; i < s->m; i++)
+            fmpz_poly_clear(s->rho + i);
+        for (i = 0; i < lenx; i++)
+            fmpz_poly_clear(s->xn + i);
+        for (k = 0; k < s->nb; k++)
+            fmpz_poly_mat_clear(s->ffLU + k);
+
+        free(s->rho);
+        free(s->xn);
+        free(s->ffLU);
+        free(s->blk);
+        free(s->fp);
+        free(s->fl);
+    }
+    else if (sum > 0)
+    {
+        _vec_clear(s->entries, sum, ctx);
+    }
+
+    if (lenx > 0)
+        _vec_clear(s->x, lenx, ctx);
+
+    free(s->F);
+    free(s->LU);
+    free(s->P);
+
+    mat_csr_analysis_clear(s->A);
+    free(s->A);
+}
+
+int mat_csr_solve_inp_raw(mat_csr_solve_t s, FILE *file, const ctx_t ctx)
+{
+    __mat_csr_analysis_struct *A;
+    char magic[4];
+    long head[5], *kind;
+    long i, k, m, nb, lenx;
+    int ok;
+
+    if (!ctx->inp_raw
+        || fread(magic, 1, 4, file) != 4
+        || memcmp(magic, MAT_CSR_SOLVE_MAGIC, 4)
+        || fread(head, sizeof(long), 5, file) != 5)
+        return 0;
+
+    m    = head[0];
+    lenx = head[2];
+    nb   = head[3];
+
+    /* Bounds that keep the sizes of all allocations from overflowing */
+    if (m <= 0 || m > LONG_MAX / 64 || head[1] != m 
+        || lenx < 0 || lenx > LONG_MAX / 64 || lenx / m > m
+        || nb < 1 || nb > m || (head[4] != 0 && head[4] != 1))
+        return 0;
+
+    /* Symbolic analysis, laid out as by mat_csr_analysis_init() */
+    A = _read_analysis(file, m, lenx, nb);
+    if (A == NULL)
+        return 0;
+
+    s->LU = malloc(m * sizeof(char *));
+    s->P  = malloc(m * sizeof(long));
+    s->F  = calloc(nb, sizeof(__mat_csr_lu_struct));
+    kind  = malloc(nb * sizeof(long));
+
+    ok = s->LU && s->P && s->F && kind 
+      && _read_longs(s->P, m, file)
+      && _read_longs(kind, nb, file)
+      && _in_range(kind, nb, 0, 2);
+
+    /* The row permutations of the dense blocks */
+    for (k = 0; ok && k < nb; k++)
+        if (!kind[k])
+            ok = _in_range(s->P + A->B[k], A->B[k + 1] - A->B[k], 
+                           0, A->B[k + 1] - A->B[k]);
+
+    if (!ok)
+    {
+        free(s->LU);
+        free(s->P);
+        free(s->F);
+        free(kind);
+        mat_csr_analysis_clear(A);
+        free(A);
+        return 0;
+    }
+
+    /* Solve structure, which owns the analysis and the values */
+    s->A    = A;
+    s->own  = 1;
+    s->ownx = 1;
+
+    s->m    = A->m;
+    s->n    = A->n;
+    s->x    = (lenx > 0) ? _vec_init(lenx, ctx) : NULL;
+    s->j    = A->j;
+    s->p    = A->p;
+    s->lenr = A->lenr;
+    s->pi   = A->pi;
+    s->qi   = A->qi;
+    s->B    = A->B;
+    s->nb   = A->nb;
+    s->cp   = A->cp;
+    s->ci   = A->ci;
+    s->cq   = A->cq;
+    s->ff   = head[4];
+
+    s->entries = NULL;
+    s->rho     = NULL;
+    s->xn      = NULL;
+    s->ffLU    = NULL;
+    s->blk     = NULL;
+    s->fp      = NULL;
+    s->fl      = NULL;
+
+    /*
+        All numerical data is allocated and initialised before it is 
+        read, so that the structure can be cleared after a failure
+     */
+    if (!(s->ff))
+    {
+        long len, sum = 0;
+
+        for (k = 0; k < nb; k++)
+        {
+            len = s->B[k + 1] - s->B[k];
+            if (!kind[k])
+                sum += len * len;
+        }
+
+        s->entries = (sum > 0) ? _vec_init(sum, ctx) : NULL;
+    }
+    else
+    {
+        s->rho  = malloc(m * sizeof(fmpz_poly_struct));
+        s->xn   = malloc(FLINT_MAX(lenx, 1) * sizeof(fmpz_poly_struct));
+        s->ffLU = malloc(nb * sizeof(fmpz_poly_mat_struct));
+        for (i = 0; i < m; i++)
+            fmpz_poly_init(s->rho + i);
+        for (i = 0; i < lenx; i++)
+            fmpz_poly_init(s->xn + i);
+        for (k = 0; k < nb; k++)
+        {
+            const long len = kind[k] ? 0 : s->B[k + 1] - s->B[k];
+
+            fmpz_poly_mat_init(s->ffLU + k, len, len);
+        }
+        _mat_csr_solve_ff_index(s);
+    }
+
+    ok = _read_elems(s->x, lenx, file, ctx);
+
+    /* Numerical data of the diagonal blocks */
+    {
+        char *off = s->entries;
+
+        for (k = 0; ok && k < nb; k++)
+        {
+            const long len = s->B[k + 1] - s->B[k];
+
+            if (kind[k])
+            {
+                ok = _read_lu_sparse(s->F + k, len, file, ctx);
+            }
+            else if (s->ff)
+            {
+                long r, c;
+
+                for (r = 0; ok && r < len; r++)
+                    for (c = 0; ok && c < len; c++)
+                        ok = _fmpz_poly_inp_raw(
+                                 fmpz_poly_mat_entry(s->ffLU + k, r, c), file);
+                for (r = 0; ok && r < len; r++)
+                    ok = !fmpz_poly_is_zero(fmpz_poly_mat_entry(s->ffLU + k, r, r));
+            }
+            else
+            {
+                long r;
+
+                for (r = 0; r < len; r++)
+                    s->LU[s->B[k] + r] = off + r * len * ctx->size;
+                for (r = 0; ok && r < len; r++)
+                    ok = _read_elems(s->LU[s->B[k] + r], len, file, ctx)
+                      && !ctx->is_zero(ctx, s->LU[s->B[k] + r] + r * ctx->size);
+                off += len * len * ctx->size;
+            }
+        }
+    }
+
+    /* Fraction-free row scalings and integral entries */
+    if (s->ff)
+    {
+        for (i = 0; ok && i < m; i++)
+            ok = _fmpz_poly_inp_raw(s->rho + i, file)
+              && !fmpz_poly_is_zero(s->rho + i);
+        for (i = 0; ok && i < lenx; i++)
+            ok = _fmpz_poly_inp_raw(s->xn + i, file);
+    }
+
+    if (!ok)
+        _mat_csr_solve_inp_clear(s, kind, ctx);
+
+    free(kind);
+
+    return ok;
+}
+
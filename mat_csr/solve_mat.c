@@ -0,0 +1,97 @@
+#include <assert.h>
+
+#include "mat.h"
+#include "vec.h"
+
+#include "mat_csr.h"
+
+long _mat_csr_solve_worklen(const mat_csr_solve_t s, long r)
+{
+    long k, lenZ = 0;
+
+    if (s->ff)
+        return _mat_csr_solve_ff_worklen(s, r);
+
+    for (k = 0; k < s->nb; k++)
+        lenZ = FLINT_MAX(lenZ, s->F[k].len);
+
+    return s->m * r + 1 + (lenZ > 0 ? lenZ * r + 1 : 0);
+}
+
+void _mat_csr_solve_mat(char *X, const mat_csr_solve_t s, const char *B, 
+                        long r, char *W, const ctx_t ctx)
+{
+    const long w = r * ctx->size;   /* Width of a row in bytes */
+    char *C, *t, *Z;
+    long e, i, k, m;
+
+    assert(s->m == s->n);
+    assert(r > 0);
+
+    if (s->ff)
+    {
+        _mat_csr_solve_ff(X, s, B, r, W, ctx);
+        return;
+    }
+
+    m = s->m;
+
+    C = W;
+    t = C + m * w;
+    Z = t + ctx->size;
+
+    for (i = 0; i < m; i++)
+        _vec_set(C + i * w, B + s->pi[i] * w, r, ctx);
+
+    for (k = 0; k < s->nb; k++)
+    {
+        const long i1  = s->B[k];
+        const long i2  = s->B[k + 1];
+        const long len = i2 - i1;
+
+        if (s->F[k].len > 0)
+            _mat_csr_lu_sparse_solve_mat(X + i1 * w, s->F + k, 
+                                         C + i1 * w, r, Z, ctx);
+        else
+            _mat_lup_solve_mat(X + i1 * w, s->LU + i1, len, len, 
+                               s->P + i1, C + i1 * w, r, t, ctx);
+
+        /* Update C.  Subtract A{bk} Y{k} from C{b} for b > k */
+        for (e = s->cp[k]; e < s->cp[k + 1]; e++)
+        {
+            const long i = s->ci[e];
+            const long q = s->cq[e];
+            const long j = s->j[q];
+            long c;
+
+            for (c = 0; c < r; c++)
+            {
+                ctx->mul(ctx, t, s->x + q * ctx->size, 
+                                 X + j * w + c * ctx->size);
+                ctx->sub(ctx, C + i * w + c * ctx->size, 
+                              C + i * w + c * ctx->size, t);
+            }
+        }
+    }
+
+    /*
+        Find Q^{-1} X, permuting whole rows by swapping them into C, 
+        which is no longer needed, and swapping C back into X
+     */
+    for (i = 0; i < m; i++)
+        _vec_swap(C + i * w, X + s->qi[i] * w, r, ctx);
+    _vec_swap(X, C, m * r, ctx);
+}
+
+void mat_csr_solve_mat(char *X, const mat_csr_solve_t s, const char *B, 
+                       long r, const ctx_t ctx)
+{
+    const long lenW = _mat_csr_solve_worklen(s, r);
+
+    char *W;
+
+    W = _vec_init(lenW, ctx);
+    _mat_csr_solve_mat(X, s, B, r, W, ctx);
+    _vec_clear(W, lenW, ctx);
+}
+
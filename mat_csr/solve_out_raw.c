@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "flint/flint.h"
+
+#include "mat_csr.h"
+
+static int _write_longs(FILE *file, const long *a, long n)
+{
+    return (n == 0) || (fwrite(a, sizeof(long), n, file) == (size_t) n);
+}
+
+static int _write_elems(FILE *file, const char *x, long n, const ctx_t ctx)
+{
+    long i;
+    int ok = 1;
+
+    for (i = 0; ok && i < n; i++)
+        ok = ctx->out_raw(ctx, file, x + i * ctx->size);
+    return ok;
+}
+
+int mat_csr_solve_out_raw(FILE *file, const mat_csr_solve_t s, const ctx_t ctx)
+{
+    const long m  = s->m;
+    const long nb = s->nb;
+
+    long i, k, lenx, head[5], *kind;
+    int ok;
+
+    if (!ctx->out_raw)
+        return 0;
+
+    /* The used length of the pattern, which is stored compactly */
+    lenx = 0;
+    for (i = 0; i < m; i++)
+        lenx = FLINT_MAX(lenx, s->p[i] + s->lenr[i]);
+
+    head[0] = s->m;
+    head[1] = s->n;
+    head[2] = lenx;
+    head[3] = nb;
+    head[4] = s->ff;
+
+    kind = calloc(nb, sizeof(long));
+    for (k = 0; k < nb; k++)
+        kind[k] = (s->F[k].len > 0);
+
+    ok = fwrite(MAT_CSR_SOLVE_MAGIC, 1, 4, file) == 4
+      && _write_longs(file, head, 5)
+      && _write_longs(file, s->j, lenx)
+      && _write_longs(file, s->p, m)
+      && _write_longs(file, s->lenr, m)
+      && _write_longs(file, s->pi, m)
+      && _write_longs(file, s->qi, m)
+      && _write_longs(file, s->B, nb + 1)
+      && _write_longs(file, s->cp, nb + 1)
+      && _write_longs(file, s->ci, s->cp[nb])
+      && _write_longs(file, s->cq, s->cp[nb])
+      && _write_longs(file, s->P, m)
+      && _write_longs(file, kind, nb)
+      && _write_elems(file, s->x, lenx, ctx);
+
+    /* Numerical data of the diagonal blocks */
+    for (k = 0; ok && k < nb; k++)
+    {
+        const long len = s->B[k + 1] - s->B[k];
+
+        if (kind[k])
+        {
+            const __mat_csr_lu_struct *F = s->F + k;
+
+            ok = _write_longs(file, F->rp, len)
+              && _write_longs(file, F->cq, len)
+              && _write_longs(file, F->Lp, len + 1)
+              && _write_longs(file, F->Up, len + 1)
+              && _write_longs(file, F->Lj, F->Lp[len])
+              && _write_longs(file, F->Uj, F->Up[len])
+              && _write_elems(file, F->Lx, F->Lp[len], ctx)
+              && _write_elems(file, F->Ux, F->Up[len], ctx);
+        }
+        else if (s->ff)
+        {
+            long r, c;
+
+            for (r = 0; ok && r < len; r++)
+                for (c = 0; ok && c < len; c++)
+                    ok = _fmpz_poly_out_raw(file,
+                             fmpz_poly_mat_entry(s->ffLU + k, r, c));
+        }
+        else
+        {
+            long r;
+
+            for (r = 0; ok && r < len; r++)
+                ok = _write_elems(file, s->LU[s->B[k] + r], len, ctx);
+        }
+    }
+
+    /* Fraction-free row scalings and integral entries */
+    if (s->ff)
+    {
+        for (i = 0; ok && i < m; i++)
+            ok = _fmpz_poly_out_raw(file, s->rho + i);
+        for (i = 0; ok && i < lenx; i++)
+            ok = _fmpz_poly_out_raw(file, s->xn + i);
+    }
+
+    free(kind);
+
+    return ok;
+}
+
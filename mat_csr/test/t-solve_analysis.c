@@ -0,0 +1,104 @@
+#include "mat_csr.h"
+#include "mat.h"
+#include "vec.h"
+
+#include "flint/flint.h"
+#include "flint/fmpz.h"
+#include "flint/ulong_extras.h"
+
+int
+main(void)
+{
+    int i, result;
+    flint_rand_t state;
+
+    printf("solve_analysis... ");
+    fflush(stdout);
+
+    _randinit(state);
+
+    /* Check that A x == b for new values on an analysed pattern */
+
+    /* Managed element type (mpq_t) */
+    for (i = 0; i < 50; i++)
+    {
+        long m, c, q, r;
+        ctx_t ctx;
+        mat_csr_t A, C;
+        mat_csr_analysis_t N;
+        mat_t B;
+        char *x, *b, *y;
+
+        m = n_randint(state, 100) + 1;
+
+        ctx_init_mpq(ctx);
+        mat_init(B, m, m, ctx);
+
+        mat_randrank(B, state, m, ctx);
+        mat_randops(B, state, m, ctx);
+
+        mat_csr_init(A, m, m, ctx);
+        mat_csr_set_mat(A, B, ctx);
+
+        mat_csr_analysis_init(N, A);
+
+        x = _vec_init(m, ctx);
+        b = _vec_init(m, ctx);
+        y = _vec_init(m, ctx);
+
+        for (c = 0; c < 3; c++)
+        {
+            mat_csr_solve_t S;
+
+            /* The same pattern, with random non-zero values */
+            mat_csr_init2(C, m, m, A->alloc, ctx);
+            for (r = 0; r < m; r++)
+            {
+                C->p[r]    = A->p[r];
+                C->lenr[r] = A->lenr[r];
+            }
+            for (q = 0; q < A->alloc; q++)
+            {
+                C->j[q] = A->j[q];
+                ctx->randtest_not_zero(ctx, C->x + q * ctx->size, state);
+            }
+
+            _vec_randtest(b, m, state, ctx);
+
+            if (!mat_csr_solve_init_analysis(S, N, C, ctx))
+            {
+                mat_csr_solve(x, S, b, ctx);
+                mat_csr_mul_vec(y, C, x, ctx);
+
+                result = _vec_equal(b, y, m, ctx);
+                if (!result)
+                {
+                    printf("FAIL:\n\n");
+                    printf("Matrix C:\n"), mat_csr_print_dense(C, ctx), printf("\n");
+                    printf("Vector b = {"), _vec_print(b, m, ctx), printf("}\n");
+                    printf("Vector x = {"), _vec_print(x, m, ctx), printf("}\n");
+                    printf("Vector y = {"), _vec_print(y, m, ctx), printf("}\n");
+                    abort();
+                }
+            }
+
+            mat_csr_solve_clear(S, ctx);
+            mat_csr_clear(C, ctx);
+        }
+
+        _vec_clear(x, m, ctx);
+        _vec_clear(b, m, ctx);
+        _vec_clear(y, m, ctx);
+
+        mat_csr_analysis_clear(N);
+        mat_csr_clear(A, ctx);
+        mat_clear(B, ctx);
+        ctx_clear(ctx);
+    }
+
+    _randclear(state);
+    _fmpz_cleanup();
+    printf("PASS\n");
+    return EXIT_SUCCESS;
+}
+
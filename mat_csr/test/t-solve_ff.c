@@ -0,0 +1,203 @@
+#include "mat_csr.h"
+#include "mat.h"
+#include "vec.h"
+
+#include "flint/flint.h"
+#include "flint/fmpz.h"
+#include "flint/ulong_extras.h"
+
+int
+main(void)
+{
+    int i, result;
+    flint_rand_t state;
+
+    printf("solve_ff... ");
+    fflush(stdout);
+
+    _randinit(state);
+
+    /* Check that A X == B, with one and several right-hand sides */
+
+    /* Managed element type (fmpz_poly_q_t) */
+    for (i = 0; i < 20; i++)
+    {
+        long m, r;
+        ctx_t ctx;
+        mat_csr_t A;
+        mat_csr_solve_t S;
+        mat_t T;
+        char *x, *b, *c, *X, *B;
+
+        m = n_randint(state, 8) + 1;
+        r = n_randint(state, 3) + 1;
+
+        ctx_init_fmpz_poly_q(ctx);
+        mat_init(T, m, m, ctx);
+
+        mat_randrank(T, state, m, ctx);
+        mat_randops(T, state, 1.5 * m, ctx);
+
+        mat_csr_init(A, m, m, ctx);
+        mat_csr_set_mat(A, T, ctx);
+
+        x = _vec_init(m, ctx);
+        b = _vec_init(m, ctx);
+        c = _vec_init(m, ctx);
+        X = _vec_init(m * r, ctx);
+        B = _vec_init(m * r, ctx);
+
+        _vec_randtest(b, m, state, ctx);
+        _vec_randtest(B, m * r, state, ctx);
+
+        result = !mat_csr_solve_init_ff(S, A, ctx);
+
+        if (result)
+        {
+            long k, l;
+
+            mat_csr_solve(x, S, b, ctx);
+            mat_csr_mul_vec(c, A, x, ctx);
+            result = _vec_equal(b, c, m, ctx);
+
+            mat_csr_solve_mat(X, S, B, r, ctx);
+            for (l = 0; result && l < r; l++)
+            {
+                for (k = 0; k < m; k++)
+                    ctx->set(ctx, x + k * ctx->size, X + (k * r + l) * ctx->size);
+                mat_csr_mul_vec(c, A, x, ctx);
+                for (k = 0; k < m; k++)
+                    result &= ctx->equal(ctx, c + k * ctx->size, 
+                                              B + (k * r + l) * ctx->size);
+            }
+
+            /* One workspace, reused for each column in turn */
+            if (result)
+            {
+                const long lenW = _mat_csr_solve_worklen(S, r);
+                char *W = _vec_init(lenW, ctx);
+
+                for (l = 0; result && l < r; l++)
+                {
+                    for (k = 0; k < m; k++)
+                        ctx->set(ctx, c + k * ctx->size, B + (k * r + l) * ctx->size);
+                    _mat_csr_solve_mat(x, S, c, 1, W, ctx);
+                    for (k = 0; k < m; k++)
+                        result &= ctx->equal(ctx, x + k * ctx->size, 
+                                                  X + (k * r + l) * ctx->size);
+                }
+
+                _vec_clear(W, lenW, ctx);
+            }
+        }
+        if (!result)
+        {
+            printf("FAIL:\n\n");
+            printf("Matrix A:\n"), mat_csr_print_dense(A, ctx), printf("\n");
+            printf("Vector b = {"), _vec_print(b, m, ctx), printf("}\n");
+            printf("Vector x = {"), _vec_print(x, m, ctx), printf("}\n");
+            printf("Vector c = {"), _vec_print(c, m, ctx), printf("}\n");
+            abort();
+        }
+
+        _vec_clear(x, m, ctx);
+        _vec_clear(b, m, ctx);
+        _vec_clear(c, m, ctx);
+        _vec_clear(X, m * r, ctx);
+        _vec_clear(B, m * r, ctx);
+
+        mat_csr_clear(A, ctx);
+        mat_csr_solve_clear(S, ctx);
+        mat_clear(T, ctx);
+        ctx_clear(ctx);
+    }
+
+    /*
+        Managed element type (fmpz_poly_q_t), with one cyclic block of 
+        length at least MAT_CSR_LU_SPARSE_MIN, which is factored sparsely
+     */
+    for (i = 0; i < 5; i++)
+    {
+        long k, l, m, r;
+        ctx_t ctx;
+        mat_csr_t A;
+        mat_csr_solve_t S;
+        mat_t T;
+        char *x, *c, *X, *B;
+
+        m = MAT_CSR_LU_SPARSE_MIN + n_randint(state, 20);
+        r = n_randint(state, 3) + 1;
+
+        ctx_init_fmpz_poly_q(ctx);
+        mat_init(T, m, m, ctx);
+
+        /* Diagonal (t + k + 2) / (t + 1), and non-zero constants above */
+        for (k = 0; k < m; k++)
+        {
+            fmpz_poly_q_struct *a = 
+                (fmpz_poly_q_struct *) mat_entry(T, k, k, ctx);
+            fmpz_poly_q_struct *b = 
+                (fmpz_poly_q_struct *) mat_entry(T, k, (k + 1) % m, ctx);
+
+            fmpz_poly_set_coeff_si(a->num, 0, k + 2);
+            fmpz_poly_set_coeff_si(a->num, 1, 1);
+            fmpz_poly_set_coeff_si(a->den, 0, 1);
+            fmpz_poly_set_coeff_si(a->den, 1, 1);
+
+            fmpz_poly_set_si(b->num, n_randint(state, 9) + 1);
+            fmpz_poly_set_si(b->den, n_randint(state, 5) + 1);
+            if (n_randint(state, 2))
+                fmpz_poly_neg(b->num, b->num);
+            fmpz_poly_q_canonicalise(b);
+        }
+
+        mat_csr_init(A, m, m, ctx);
+        mat_csr_set_mat(A, T, ctx);
+
+        x = _vec_init(m, ctx);
+        c = _vec_init(m, ctx);
+        X = _vec_init(m * r, ctx);
+        B = _vec_init(m * r, ctx);
+
+        _vec_randtest(B, m * r, state, ctx);
+
+        result = !mat_csr_solve_init_ff(S, A, ctx) 
+              && S->nb == 1 && S->F[0].len > 0;
+
+        if (result)
+        {
+            mat_csr_solve_mat(X, S, B, r, ctx);
+            for (l = 0; result && l < r; l++)
+            {
+                for (k = 0; k < m; k++)
+                    ctx->set(ctx, x + k * ctx->size, X + (k * r + l) * ctx->size);
+                mat_csr_mul_vec(c, A, x, ctx);
+                for (k = 0; k < m; k++)
+                    result &= ctx->equal(ctx, c + k * ctx->size, 
+                                              B + (k * r + l) * ctx->size);
+            }
+        }
+        if (!result)
+        {
+            printf("FAIL (sparse block):\n\n");
+            printf("Matrix A:\n"), mat_csr_print_dense(A, ctx), printf("\n");
+            printf("Number of blocks = %ld\n", S->nb);
+            abort();
+        }
+
+        _vec_clear(x, m, ctx);
+        _vec_clear(c, m, ctx);
+        _vec_clear(X, m * r, ctx);
+        _vec_clear(B, m * r, ctx);
+
+        mat_csr_clear(A, ctx);
+        mat_csr_solve_clear(S, ctx);
+        mat_clear(T, ctx);
+        ctx_clear(ctx);
+    }
+
+    _randclear(state);
+    _fmpz_cleanup();
+    printf("PASS\n");
+    return EXIT_SUCCESS;
+}
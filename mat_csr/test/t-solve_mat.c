@@ -0,0 +1,102 @@
+#include "mat_csr.h"
+#include "mat.h"
+#include "vec.h"
+
+#include "flint/flint.h"
+#include "flint/fmpz.h"
+#include "flint/ulong_extras.h"
+
+int
+main(void)
+{
+    int i, result;
+    flint_rand_t state;
+
+    printf("solve_mat... ");
+    fflush(stdout);
+
+    _randinit(state);
+
+    /*
+        Check that each column of X agrees with the solution of A x = b 
+        for the column b of B, solved with one workspace for all columns
+     */
+
+    /* Managed element type (mpq_t) */
+    for (i = 0; i < 100; i++)
+    {
+        long c, k, m, r;
+        ctx_t ctx;
+        mat_csr_t A;
+        mat_csr_solve_t S;
+        mat_t T;
+        char *X, *B, *x, *b, *y, *W;
+        long lenW;
+
+        m = n_randint(state, 100) + 1;
+        r = n_randint(state, 8) + 1;
+
+        ctx_init_mpq(ctx);
+        mat_init(T, m, m, ctx);
+
+        mat_randrank(T, state, m, ctx);
+        mat_randops(T, state, 1.5 * m, ctx);
+
+        mat_csr_init(A, m, m, ctx);
+        mat_csr_set_mat(A, T, ctx);
+
+        X = _vec_init(m * r, ctx);
+        B = _vec_init(m * r, ctx);
+        x = _vec_init(m, ctx);
+        b = _vec_init(m, ctx);
+        y = _vec_init(m, ctx);
+
+        _vec_randtest(B, m * r, state, ctx);
+
+        mat_csr_solve_init(S, A, ctx);
+        mat_csr_solve_mat(X, S, B, r, ctx);
+
+        lenW = _mat_csr_solve_worklen(S, r);
+        W = _vec_init(lenW, ctx);
+
+        for (c = 0; c < r; c++)
+        {
+            for (k = 0; k < m; k++)
+                ctx->set(ctx, b + k * ctx->size, B + (k * r + c) * ctx->size);
+
+            _mat_csr_solve_mat(x, S, b, 1, W, ctx);
+            mat_csr_mul_vec(y, A, x, ctx);
+
+            result = _vec_equal(b, y, m, ctx);
+            for (k = 0; k < m; k++)
+                result &= ctx->equal(ctx, x + k * ctx->size, 
+                                          X + (k * r + c) * ctx->size);
+            if (!result)
+            {
+                printf("FAIL:\n\n");
+                printf("Matrix A:\n"), mat_csr_print_dense(A, ctx), printf("\n");
+                printf("Column c = %ld\n", c);
+                printf("Vector b = {"), _vec_print(b, m, ctx), printf("}\n");
+                printf("Vector x = {"), _vec_print(x, m, ctx), printf("}\n");
+                abort();
+            }
+        }
+
+        _vec_clear(X, m * r, ctx);
+        _vec_clear(B, m * r, ctx);
+        _vec_clear(x, m, ctx);
+        _vec_clear(b, m, ctx);
+        _vec_clear(y, m, ctx);
+        _vec_clear(W, lenW, ctx);
+
+        mat_csr_clear(A, ctx);
+        mat_csr_solve_clear(S, ctx);
+        mat_clear(T, ctx);
+        ctx_clear(ctx);
+    }
+
+    _randclear(state);
+    _fmpz_cleanup();
+    printf("PASS\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,308 @@
+#include <limits.h>
+#include <string.h>
+
+#include "mat_csr.h"
+#include "mat.h"
+#include "vec.h"
+
+#include "flint/flint.h"
+#include "flint/fmpz.h"
+#include "flint/ulong_extras.h"
+
+int
+main(void)
+{
+    int i, result;
+    flint_rand_t state;
+
+    printf("solve_out_raw/inp_raw... ");
+    fflush(stdout);
+
+    _randinit(state);
+
+    /* Check that a loaded solve structure gives the same solutions */
+
+    /* Managed element type (mpq_t), with dense and sparse blocks */
+    for (i = 0; i < 50; i++)
+    {
+        long m;
+        ctx_t ctx;
+        mat_csr_t A;
+        mat_csr_solve_t S, T;
+        mat_t B;
+        char *x, *y, *b;
+        FILE *file;
+
+        m = n_randint(state, 150) + 1;
+
+        ctx_init_mpq(ctx);
+        mat_init(B, m, m, ctx);
+
+        mat_randrank(B, state, m, ctx);
+        mat_randops(B, state, m / 2, ctx);
+
+        mat_csr_init(A, m, m, ctx);
+        mat_csr_set_mat(A, B, ctx);
+
+        x = _vec_init(m, ctx);
+        y = _vec_init(m, ctx);
+        b = _vec_init(m, ctx);
+
+        _vec_randtest(b, m, state, ctx);
+
+        mat_csr_solve_init(S, A, ctx);
+
+        file = tmpfile();
+        result = mat_csr_solve_out_raw(file, S, ctx);
+        rewind(file);
+        result = result && mat_csr_solve_inp_raw(T, file, ctx);
+        fclose(file);
+
+        if (result)
+        {
+            mat_csr_solve(x, S, b, ctx);
+            mat_csr_solve(y, T, b, ctx);
+            result = _vec_equal(x, y, m, ctx);
+            mat_csr_solve_clear(T, ctx);
+        }
+        if (!result)
+        {
+            printf("FAIL (mpq_t):\n\n");
+            printf("Matrix A:\n"), mat_csr_print_dense(A, ctx), printf("\n");
+            printf("Vector b = {"), _vec_print(b, m, ctx), printf("}\n");
+            printf("Vector x = {"), _vec_print(x, m, ctx), printf("}\n");
+            printf("Vector y = {"), _vec_print(y, m, ctx), printf("}\n");
+            abort();
+        }
+
+        _vec_clear(x, m, ctx);
+        _vec_clear(y, m, ctx);
+        _vec_clear(b, m, ctx);
+
+        mat_csr_solve_clear(S, ctx);
+        mat_csr_clear(A, ctx);
+        mat_clear(B, ctx);
+        ctx_clear(ctx);
+    }
+
+    /* Managed element type (fmpz_poly_q_t), fraction-free */
+    for (i = 0; i < 20; i++)
+    {
+        long m;
+        ctx_t ctx;
+        mat_csr_t A;
+        mat_csr_solve_t S, T;
+        mat_t B;
+        char *x, *y, *b;
+        FILE *file;
+
+        m = n_randint(state, 8) + 1;
+
+        ctx_init_fmpz_poly_q(ctx);
+        mat_init(B, m, m, ctx);
+
+        mat_randrank(B, state, m, ctx);
+        mat_randops(B, state, 1.5 * m, ctx);
+
+        mat_csr_init(A, m, m, ctx);
+        mat_csr_set_mat(A, B, ctx);
+
+        x = _vec_init(m, ctx);
+        y = _vec_init(m, ctx);
+        b = _vec_init(m, ctx);
+
+        _vec_randtest(b, m, state, ctx);
+
+        if (!mat_csr_solve_init_ff(S, A, ctx))
+        {
+            file = tmpfile();
+            result = mat_csr_solve_out_raw(file, S, ctx);
+            rewind(file);
+            result = result && mat_csr_solve_inp_raw(T, file, ctx);
+            fclose(file);
+
+            if (result)
+            {
+                mat_csr_solve(x, S, b, ctx);
+                mat_csr_solve(y, T, b, ctx);
+                result = _vec_equal(x, y, m, ctx);
+                mat_csr_solve_clear(T, ctx);
+            }
+            if (!result)
+            {
+                printf("FAIL (fmpz_poly_q_t):\n\n");
+                printf("Matrix A:\n"), mat_csr_print_dense(A, ctx), printf("\n");
+                printf("Vector b = {"), _vec_print(b, m, ctx), printf("}\n");
+                printf("Vector x = {"), _vec_print(x, m, ctx), printf("}\n");
+                printf("Vector y = {"), _vec_print(y, m, ctx), printf("}\n");
+                abort();
+            }
+        }
+
+        _vec_clear(x, m, ctx);
+        _vec_clear(y, m, ctx);
+        _vec_clear(b, m, ctx);
+
+        mat_csr_solve_clear(S, ctx);
+        mat_csr_clear(A, ctx);
+        mat_clear(B, ctx);
+        ctx_clear(ctx);
+    }
+
+    /* Check that truncated and corrupted streams are rejected */
+    for (i = 0; i < 10; i++)
+    {
+        long k, m, len, lenx;
+        ctx_t ctx;
+        mat_csr_t A;
+        mat_csr_solve_t S, T;
+        mat_t B;
+        char *data;
+        FILE *file;
+
+        m = n_randint(state, 12) + 1;
+
+        ctx_init_mpq(ctx);
+        mat_init(B, m, m, ctx);
+
+        mat_randrank(B, state, m, ctx);
+        mat_randops(B, state, m / 2, ctx);
+
+        mat_csr_init(A, m, m, ctx);
+        mat_csr_set_mat(A, B, ctx);
+
+        mat_csr_solve_init(S, A, ctx);
+
+        file = tmpfile();
+        result = mat_csr_solve_out_raw(file, S, ctx);
+        len = ftell(file);
+        rewind(file);
+        data = malloc(len);
+        result = result && (fread(data, 1, len, file) == (size_t) len);
+        fclose(file);
+
+        /* Truncations to k bytes, then an index out of range */
+        memcpy(&lenx, data + 4 + 2 * sizeof(long), sizeof(long));
+        for (k = 0; result && k <= len + 1; k++)
+        {
+            long off = -1, v = 0, w = 0;
+
+            if (k == len)
+            {
+                /* The first entry of the row permutation */
+                off = 4 + (5 + lenx + 2 * m) * sizeof(long);
+                w   = m;
+            }
+            if (k == len + 1)
+            {
+                /* The number of blocks */
+                off = 4 + 3 * sizeof(long);
+                w   = m + 1;
+            }
+            if (off >= 0)
+            {
+                memcpy(&v, data + off, sizeof(long));
+                memcpy(data + off, &w, sizeof(long));
+            }
+
+            file = tmpfile();
+            fwrite(data, 1, FLINT_MIN(k, len), file);
+            rewind(file);
+            result = !mat_csr_solve_inp_raw(T, file, ctx);
+            fclose(file);
+
+            if (off >= 0)
+                memcpy(data + off, &v, sizeof(long));
+
+            if (!result)
+            {
+                printf("FAIL (corrupt):\n\n");
+                printf("Matrix A:\n"), mat_csr_print_dense(A, ctx), printf("\n");
+                printf("len = %ld, k = %ld\n", len, k);
+                abort();
+            }
+        }
+
+        free(data);
+
+        mat_csr_solve_clear(S, ctx);
+        mat_csr_clear(A, ctx);
+        mat_clear(B, ctx);
+        ctx_clear(ctx);
+    }
+
+    /* Check that corrupted element lengths are rejected */
+    for (i = 0; i < 10; i++)
+    {
+        long k, m, len, lenx, off;
+        ctx_t ctx;
+        mat_csr_t A;
+        mat_csr_solve_t S, T;
+        mat_t B;
+        char *data;
+        FILE *file;
+
+        m = n_randint(state, 8) + 1;
+
+        ctx_init_fmpz_poly_q(ctx);
+        mat_init(B, m, m, ctx);
+
+        mat_randrank(B, state, m, ctx);
+        mat_randops(B, state, 1.5 * m, ctx);
+
+        mat_csr_init(A, m, m, ctx);
+        mat_csr_set_mat(A, B, ctx);
+
+        if (!mat_csr_solve_init_ff(S, A, ctx))
+        {
+            file = tmpfile();
+            result = mat_csr_solve_out_raw(file, S, ctx);
+            len = ftell(file);
+            rewind(file);
+            data = malloc(len);
+            result = result && (fread(data, 1, len, file) == (size_t) len);
+            fclose(file);
+
+            /* The length of the numerator of the first stored entry */
+            memcpy(&lenx, data + 4 + 2 * sizeof(long), sizeof(long));
+            off = 4 + (5 + lenx + 5 * m + 2 * (S->nb + 1) 
+                       + 2 * S->cp[S->nb] + S->nb) * sizeof(long);
+
+            for (k = 0; result && lenx > 0 && k < 2; k++)
+            {
+                long v, w = (k == 0) ? LONG_MAX : (1L << 40);
+
+                memcpy(&v, data + off, sizeof(long));
+                memcpy(data + off, &w, sizeof(long));
+
+                file = tmpfile();
+                fwrite(data, 1, len, file);
+                rewind(file);
+                result = !mat_csr_solve_inp_raw(T, file, ctx);
+                fclose(file);
+
+                memcpy(data + off, &v, sizeof(long));
+            }
+
+            if (!result)
+            {
+                printf("FAIL (corrupt length):\n\n");
+                printf("Matrix A:\n"), mat_csr_print_dense(A, ctx), printf("\n");
+                abort();
+            }
+
+            free(data);
+        }
+
+        mat_csr_solve_clear(S, ctx);
+        mat_csr_clear(A, ctx);
+        mat_clear(B, ctx);
+        ctx_clear(ctx);
+    }
+
+    _randclear(state);
+    _fmpz_cleanup();
+    printf("PASS\n");
+    return EXIT_SUCCESS;
+}
+
@@ -145,6 +145,8 @@ void mpoly_submul(mpoly_t rop, const mpoly_t op1, const mpoly_t op2,
 void mpoly_derivative(mpoly_t rop, const mpoly_t op, int var, 
                       const ctx_t ctx);
 
+void mpoly_tderivative(mpoly_t rop, const mpoly_t op, const ctx_t ctx);
+
 /* Input and output **********************************************************/
 
 int mpoly_set_str(mpoly_t rop, const char *str, const ctx_t ctx);
@@ -0,0 +1,47 @@
+#include "mpoly.h"
+
+void mpoly_tderivative(mpoly_t rop, const mpoly_t op, const ctx_t ctx)
+{
+    mpoly_t temp;
+    
+    mpoly_iter_t iter;
+    mpoly_term t;
+    
+    if (mpoly_is_zero(op, ctx))
+    {
+        mpoly_zero(rop, ctx);
+        rop->n = op->n;
+        return;
+    }
+    
+    mpoly_init(temp, op->n, ctx);
+    
+    mpoly_iter_init(iter, op);
+    while ((t = mpoly_iter_next(iter)))
+    {
+        char *c;
+
+        c = malloc(ctx->size);
+        ctx->init(ctx, c);
+        ctx->derivative(ctx, c, t->val);
+
+        if (ctx->is_zero(ctx, c))
+        {
+            ctx->clear(ctx, c);
+            free(c);
+        }
+        else
+        {
+            mon_t m2;
+            void *c2;
+
+            /* Note that no entry with this key is present in temp yet */
+            RBTREE_INSERT(mpoly, &m2, &c2, temp->dict, t->key, c, &mon_cmp);
+        }
+    }
+    mpoly_iter_clear(iter);
+    
+    mpoly_swap(rop, temp, ctx);
+    mpoly_clear(temp, ctx);
+}
+